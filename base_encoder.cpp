@@ -0,0 +1,188 @@
+// base_encoder.cpp
+
+#include "base_encoder.hpp"
+#include <cstring>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CARL_X86
+#endif
+
+namespace carl {
+
+namespace {
+
+/*
+ * code and flag of every byte value: bits 0-1 are the base, bit 2 is set
+ * for an indefinite base
+ */
+struct CodeTable {
+    unsigned char codes[256];
+    CodeTable() {
+        std::memset(codes, 4, sizeof(codes));
+        codes['a'] = codes['A'] = 0;
+        codes['c'] = codes['C'] = 1;
+        codes['g'] = codes['G'] = 2;
+        codes['t'] = codes['T'] = 3;
+    }
+};
+
+const CodeTable code_table;
+
+void encode_scalar(const char* sequence, std::size_t size,
+        unsigned char* bases, unsigned char* flags) {
+    const unsigned char* codes(code_table.codes);
+    std::size_t i(0);
+    for (; i + 8 <= size; i += 8) {
+        unsigned char c[8];
+        for (int j(0); j < 8; j++) {
+            c[j] = codes[static_cast<unsigned char>(sequence[i + j])];
+        }
+        bases[i >> 2] = (c[0] & 3) | ((c[1] & 3) << 2) |
+            ((c[2] & 3) << 4) | ((c[3] & 3) << 6);
+        bases[(i >> 2) + 1] = (c[4] & 3) | ((c[5] & 3) << 2) |
+            ((c[6] & 3) << 4) | ((c[7] & 3) << 6);
+        unsigned char flg(0);
+        for (int j(0); j < 8; j++) {
+            flg |= (c[j] >> 2) << j;
+        }
+        flags[i >> 3] = flg;
+    }
+    if (i == size)
+        return;
+    std::memset(bases + (i >> 2), 0, ((size + 3) >> 2) - (i >> 2));
+    flags[i >> 3] = 0;
+    for (; i < size; i++) {
+        const unsigned char c(codes[static_cast<unsigned char>(sequence[i])]);
+        bases[i >> 2] |= (c & 3) << ((i & 3) << 1);
+        flags[i >> 3] |= (c >> 2) << (i & 7);
+    }
+}
+
+#ifdef CARL_X86
+
+/*
+ * For acgt/ACGT, ((c >> 1) & 3) ^ ((c >> 2) & 1) is the 2-bit code,
+ * and c & 0xdf folds the case before the comparison.
+ */
+__attribute__((target("sse4.2")))
+void encode_sse42(const char* sequence, std::size_t size,
+        unsigned char* bases, unsigned char* flags) {
+    const __m128i three(_mm_set1_epi8(3)), one(_mm_set1_epi8(1));
+    const __m128i upper(_mm_set1_epi8(static_cast<char>(0xdf)));
+    const __m128i a(_mm_set1_epi8('A')), c(_mm_set1_epi8('C'));
+    const __m128i g(_mm_set1_epi8('G')), t(_mm_set1_epi8('T'));
+    const __m128i pairs(_mm_set1_epi16(0x0401)), quads(_mm_set1_epi32(0x00100001));
+    const __m128i gather(_mm_setr_epi8(0, 4, 8, 12,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    std::size_t i(0);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i v(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(sequence + i)));
+        const __m128i u(_mm_and_si128(v, upper));
+        const __m128i valid(_mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(u, a), _mm_cmpeq_epi8(u, c)),
+                    _mm_or_si128(_mm_cmpeq_epi8(u, g), _mm_cmpeq_epi8(u, t))));
+        __m128i code(_mm_xor_si128(
+                    _mm_and_si128(_mm_srli_epi16(v, 1), three),
+                    _mm_and_si128(_mm_srli_epi16(v, 2), one)));
+        code = _mm_and_si128(code, valid);
+        const __m128i packed(_mm_shuffle_epi8(_mm_madd_epi16(
+                        _mm_maddubs_epi16(code, pairs), quads), gather));
+        const uint32_t packed_bases(_mm_cvtsi128_si32(packed));
+        const uint16_t packed_flags(~_mm_movemask_epi8(valid));
+        std::memcpy(bases + (i >> 2), &packed_bases, sizeof(packed_bases));
+        std::memcpy(flags + (i >> 3), &packed_flags, sizeof(packed_flags));
+    }
+    encode_scalar(sequence + i, size - i, bases + (i >> 2), flags + (i >> 3));
+}
+
+__attribute__((target("avx2")))
+void encode_avx2(const char* sequence, std::size_t size,
+        unsigned char* bases, unsigned char* flags) {
+    const __m256i three(_mm256_set1_epi8(3)), one(_mm256_set1_epi8(1));
+    const __m256i upper(_mm256_set1_epi8(static_cast<char>(0xdf)));
+    const __m256i a(_mm256_set1_epi8('A')), c(_mm256_set1_epi8('C'));
+    const __m256i g(_mm256_set1_epi8('G')), t(_mm256_set1_epi8('T'));
+    const __m256i pairs(_mm256_set1_epi16(0x0401)), quads(_mm256_set1_epi32(0x00100001));
+    const __m256i gather(_mm256_setr_epi8(0, 4, 8, 12,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                0, 4, 8, 12,
+                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    std::size_t i(0);
+    for (; i + 32 <= size; i += 32) {
+        const __m256i v(_mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(sequence + i)));
+        const __m256i u(_mm256_and_si256(v, upper));
+        const __m256i valid(_mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(u, a), _mm256_cmpeq_epi8(u, c)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(u, g), _mm256_cmpeq_epi8(u, t))));
+        __m256i code(_mm256_xor_si256(
+                    _mm256_and_si256(_mm256_srli_epi16(v, 1), three),
+                    _mm256_and_si256(_mm256_srli_epi16(v, 2), one)));
+        code = _mm256_and_si256(code, valid);
+        const __m256i packed(_mm256_shuffle_epi8(_mm256_madd_epi16(
+                        _mm256_maddubs_epi16(code, pairs), quads), gather));
+        const uint32_t low(_mm256_extract_epi32(packed, 0));
+        const uint32_t high(_mm256_extract_epi32(packed, 4));
+        const uint32_t packed_flags(~_mm256_movemask_epi8(valid));
+        std::memcpy(bases + (i >> 2), &low, sizeof(low));
+        std::memcpy(bases + (i >> 2) + 4, &high, sizeof(high));
+        std::memcpy(flags + (i >> 3), &packed_flags, sizeof(packed_flags));
+    }
+    encode_sse42(sequence + i, size - i, bases + (i >> 2), flags + (i >> 3));
+}
+
+#endif
+
+} // anonymous
+
+void BaseEncoder::encode(Kind kind, const char* sequence, std::size_t size,
+        unsigned char* bases, unsigned char* flags) {
+    if (!isSupported(kind))
+        kind = Scalar;
+    _function(kind)(sequence, size, bases, flags);
+}
+
+bool BaseEncoder::isSupported(Kind kind) {
+    switch (kind) {
+#ifdef CARL_X86
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+        case SSE42:
+            return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("ssse3");
+#endif
+        case Scalar:
+            return true;
+        default:
+            return false;
+    }
+}
+
+BaseEncoder::Kind BaseEncoder::best() {
+    if (isSupported(AVX2))
+        return AVX2;
+    if (isSupported(SSE42))
+        return SSE42;
+    return Scalar;
+}
+
+BaseEncoder::function_type BaseEncoder::_function(Kind kind) {
+    switch (kind) {
+#ifdef CARL_X86
+        case AVX2:
+            return &encode_avx2;
+        case SSE42:
+            return &encode_sse42;
+#endif
+        default:
+            return &encode_scalar;
+    }
+}
+
+BaseEncoder::function_type BaseEncoder::_best() {
+    static const function_type function(_function(best()));
+    return function;
+}
+
+} // carl
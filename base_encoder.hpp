@@ -0,0 +1,49 @@
+// base_encoder.hpp
+
+#ifndef __BASE_ENCODER_hpp
+#define __BASE_ENCODER_hpp
+
+#include <cstddef>
+
+namespace carl {
+
+/*
+ * Converts ASCII bases into the packed layout of Read:
+ * 2 bits per base (a=0, c=1, g=2, t=3; anything else 0) four to a byte,
+ * and 1 flag bit per base (set for anything but acgt/ACGT) eight to
+ * a byte, the first base in the lowest bits.
+ * The SIMD kernels handle 16 (SSE4.2) or 32 (AVX2) bases per step and
+ * the one to use is picked once from the running CPU.
+ */
+class BaseEncoder {
+public:
+    enum Kind {
+        Scalar,
+        SSE42,
+        AVX2
+    };
+
+    typedef void (*function_type)(const char* sequence, std::size_t size,
+            unsigned char* bases, unsigned char* flags);
+
+    /*
+     * bases and flags must hold (size + 3) / 4 and (size + 7) / 8 bytes;
+     * every one of them is overwritten.
+     */
+    static void encode(const char* sequence, std::size_t size,
+            unsigned char* bases, unsigned char* flags) {
+        _best()(sequence, size, bases, flags);
+    }
+    static void encode(Kind kind, const char* sequence, std::size_t size,
+            unsigned char* bases, unsigned char* flags);
+    static bool isSupported(Kind kind);
+    static Kind best();
+
+private:
+    static function_type _function(Kind kind);
+    static function_type _best();
+};
+
+} // carl
+
+#endif
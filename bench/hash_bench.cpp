@@ -0,0 +1,115 @@
+// hash_bench.cpp
+//
+// Compares the bucket distribution of std::unordered_set<Read> under the
+// old positional hash and the current hash_value.
+//
+//   hash_bench mer_file          the k-mers of a mer file
+//   hash_bench read_file k       every k-mer of the reads in read_file
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "../fasta_reader.hpp"
+#include "../read.hpp"
+
+using namespace carl;
+
+namespace {
+
+// the hash before packed words: 2 bits per base after a leading 1,
+// so only the last 31 bases reach the result
+struct OldHash {
+    std::size_t operator()(const Read& read) const {
+        std::size_t h(1);
+        for (Read::size_type i(0); i < read.size(); i++) {
+            h = (h << 2) + (read.getBaseAt(i) & 3);
+        }
+        return h;
+    }
+};
+
+struct NewHash {
+    std::size_t operator()(const Read& read) const {
+        return hash_value(read);
+    }
+};
+
+std::vector<Read> load_mers(const std::string& filename, const std::size_t k) {
+    std::vector<Read> mers;
+    FastaReader reader(filename);
+    FastaReader::Record record;
+    while (reader.next(record)) {
+        if (k == 0) {
+            mers.push_back(Read(record.sequence.data, record.sequence.size));
+            continue;
+        }
+        for (std::size_t i(0); i + k <= record.sequence.size; i++) {
+            mers.push_back(Read(record.sequence.data + i, k));
+        }
+    }
+    return mers;
+}
+
+template <class Hash>
+void report(const std::string& name, const std::vector<Read>& mers) {
+    typedef std::unordered_set<Read, Hash> set_type;
+    set_type table(mers.begin(), mers.end());
+
+    std::unordered_set<std::size_t> hashes;
+    std::size_t occupied(0), longest(0), probes(0);
+    for (std::size_t i(0); i < table.bucket_count(); i++) {
+        const std::size_t size(table.bucket_size(i));
+        occupied += size != 0;
+        longest = std::max(longest, size);
+        // comparisons to find every key of the bucket
+        probes += size * (size + 1) / 2;
+    }
+    for (typename set_type::const_iterator itr(table.begin());
+            itr != table.end(); itr++) {
+        hashes.insert(Hash()(*itr));
+    }
+
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    std::size_t found(0);
+    for (std::size_t round(0); round < 10; round++) {
+        for (std::vector<Read>::const_iterator itr(mers.begin());
+                itr != mers.end(); itr++) {
+            found += table.count(*itr);
+        }
+    }
+    const double seconds(std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count());
+
+    std::cout << std::setw(4) << name
+        << "  keys " << table.size()
+        << "  distinct hashes " << hashes.size()
+        << "  buckets " << table.bucket_count()
+        << "  occupied " << occupied
+        << "  longest chain " << longest
+        << "  mean probes " << std::fixed << std::setprecision(3)
+        << (table.empty() ? 0.0 : double(probes) / table.size())
+        << "  lookups/s " << std::setprecision(0)
+        << (seconds > 0 ? found / seconds : 0.0)
+        << std::endl;
+}
+
+} // anonymous
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " mer_file" << std::endl
+                  << "       " << argv[0] << " read_file k" << std::endl;
+        return 1;
+    }
+    const std::size_t k(argc == 3 ? std::atoi(argv[2]) : 0);
+    const std::vector<Read> mers(load_mers(argv[1], k));
+    std::cout << mers.size() << " mers from " << argv[1] << std::endl;
+
+    report<OldHash>("old", mers);
+    report<NewHash>("new", mers);
+    return 0;
+}
@@ -0,0 +1,352 @@
+// suite_bench.cpp
+//
+// Micro and macro benchmarks of the hot paths, run by `make bench`.
+// Every benchmark repeats a pass over its inputs until --min-time has
+// elapsed and reports ns/op, bases/s and heap allocations per op.
+//
+//   suite_bench [--json] [--min-time s] [--mers n] [read_file [mer_file]]
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+#include "../fasta.hpp"
+#include "../fasta_reader.hpp"
+#include "../filter.hpp"
+#include "../read.hpp"
+
+using namespace carl;
+
+/*
+ * every allocation of the process goes through here
+ */
+namespace {
+std::size_t allocations(0);
+}
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* p(std::malloc(size == 0 ? 1 : size));
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// keeps results alive so the work is not optimized away
+volatile std::size_t sink;
+
+class Result {
+public:
+    std::string name;
+    std::size_t ops;
+    double seconds;
+    double bases;
+    std::size_t allocations;
+
+    double nsPerOp() const {
+        return ops == 0 ? 0. : seconds * 1e9 / ops;
+    }
+    double basesPerSecond() const {
+        return seconds == 0. ? 0. : bases / seconds;
+    }
+    double allocationsPerOp() const {
+        return ops == 0 ? 0. : double(allocations) / ops;
+    }
+};
+
+class Suite {
+private:
+    double _min_time;
+    std::vector<Result> _results;
+
+public:
+    Suite(const double min_time) : _min_time(min_time) {
+    }
+
+    /*
+     * pass() runs ops operations over bases bases; passes are doubled
+     * until they take min_time
+     */
+    void run(const std::string& name, const std::size_t ops, const double bases,
+            const std::function<void()>& pass) {
+        pass();   // warm up
+        std::size_t passes(1);
+        for (;;) {
+            const std::size_t allocated(allocations);
+            const std::chrono::steady_clock::time_point start(
+                    std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < passes; i++) {
+                pass();
+            }
+            const double seconds(std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count());
+            if (seconds >= _min_time || passes >= (std::size_t(1) << 30)) {
+                Result result;
+                result.name = name;
+                result.ops = ops * passes;
+                result.seconds = seconds;
+                result.bases = bases * passes;
+                result.allocations = allocations - allocated;
+                _results.push_back(result);
+                std::cerr << "  " << name << std::endl;
+                return;
+            }
+            passes *= 2;
+        }
+    }
+
+    void printText(std::ostream& os) const {
+        os << std::left << std::setw(28) << "benchmark"
+           << std::right << std::setw(14) << "ns/op"
+           << std::setw(16) << "Mbases/s"
+           << std::setw(12) << "allocs/op" << std::endl;
+        for (std::vector<Result>::const_iterator itr(_results.begin());
+                itr != _results.end(); itr++) {
+            os << std::left << std::setw(28) << itr->name << std::right
+               << std::fixed << std::setprecision(1)
+               << std::setw(14) << itr->nsPerOp()
+               << std::setw(16) << itr->basesPerSecond() / 1e6
+               << std::setprecision(2)
+               << std::setw(12) << itr->allocationsPerOp() << std::endl;
+        }
+    }
+
+    void printJson(std::ostream& os) const {
+        os << "[" << std::endl;
+        for (std::vector<Result>::const_iterator itr(_results.begin());
+                itr != _results.end(); itr++) {
+            os << "  {\"name\": \"" << itr->name << "\""
+               << ", \"ops\": " << itr->ops
+               << ", \"seconds\": " << itr->seconds
+               << ", \"ns_per_op\": " << itr->nsPerOp()
+               << ", \"bases_per_s\": " << itr->basesPerSecond()
+               << ", \"allocs_per_op\": " << itr->allocationsPerOp()
+               << "}" << (itr + 1 == _results.end() ? "" : ",") << std::endl;
+        }
+        os << "]" << std::endl;
+    }
+};
+
+std::vector<std::string> load_sequences(const std::string& filename) {
+    std::vector<std::string> sequences;
+    FastaReader reader(filename);
+    FastaReader::Record record;
+    while (reader.next(record)) {
+        sequences.push_back(record.sequence.str());
+    }
+    return sequences;
+}
+
+std::string random_sequence(const std::size_t size) {
+    static const char alphabet[] = "ACGT";
+    std::string retval(size, 'A');
+    for (std::size_t i(0); i < size; i++) {
+        retval[i] = alphabet[std::rand() & 3];
+    }
+    return retval;
+}
+
+double total_size(const std::vector<std::string>& sequences) {
+    double size(0);
+    for (std::size_t i(0); i < sequences.size(); i++) {
+        size += sequences[i].size();
+    }
+    return size;
+}
+
+void bench_reads(Suite& suite, const std::string& label,
+        const std::vector<std::string>& sequences) {
+    const double bases(total_size(sequences));
+    std::vector<Read> reads(sequences.begin(), sequences.end());
+
+    suite.run("read.construct/" + label, sequences.size(), bases, [&]() {
+        for (std::size_t i(0); i < sequences.size(); i++) {
+            const Read read(sequences[i]);
+            sink = sink + read.size();
+        }
+    });
+    suite.run("read.reverse/" + label, reads.size(), bases, [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            sink = sink + reads[i].reverse().size();
+        }
+    });
+    suite.run("read.complement/" + label, reads.size(), bases, [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            sink = sink + reads[i].complement().size();
+        }
+    });
+
+    std::size_t subs(0);
+    for (std::size_t i(0); i < reads.size(); i++) {
+        subs += reads[i].size() >= 25 ? reads[i].size() - 24 : 0;
+    }
+    suite.run("read.sub25/" + label, subs, subs * 25., [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            for (Read::size_type j(0); j + 25 <= reads[i].size(); j++) {
+                sink = sink + reads[i].sub(j, 25).size();
+            }
+        }
+    });
+
+    const Read::size_type lengths[] = {25, 41};
+    for (int l(0); l < 2; l++) {
+        std::vector<Read> mers;
+        for (std::size_t i(0); i < reads.size() && mers.size() < 100000; i++) {
+            for (Read::size_type j(0); j + lengths[l] <= reads[i].size(); j += lengths[l]) {
+                mers.push_back(reads[i].sub(j, lengths[l]));
+            }
+        }
+        std::ostringstream name;
+        name << "read.hash" << lengths[l] << "/" << label;
+        suite.run(name.str(), mers.size(), double(mers.size()) * lengths[l], [&]() {
+            for (std::size_t i(0); i < mers.size(); i++) {
+                sink = sink + hash_value(mers[i]);
+            }
+        });
+    }
+}
+
+void bench_filter(Suite& suite, const std::string& label, const Filter& filter,
+        const std::vector<std::string>& sequences) {
+    const double bases(total_size(sequences));
+    std::vector<Read> reads(sequences.begin(), sequences.end());
+
+    suite.run("filter.scores/" + label, reads.size(), bases, [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            sink = sink + filter.scores(reads[i]).size();
+        }
+    });
+    suite.run("filter.check/" + label, reads.size(), bases, [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            sink = sink + filter.check(reads[i]);
+        }
+    });
+    suite.run("filter.average/" + label, reads.size(), bases, [&]() {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            sink = sink + std::size_t(filter.average(reads[i]));
+        }
+    });
+}
+
+} // anonymous
+
+int main(int argc, char* argv[]) {
+    double min_time(0.2);
+    std::size_t mer_count(1000000);
+    std::string read_file("samples/sample.fasta"), mer_file("samples/sample.count");
+
+    using namespace boost::program_options;
+    options_description options("");
+    options.add_options()
+        ("json", "print the results as JSON")
+        ("min-time", value<double>(&min_time), "seconds per benchmark")
+        ("mers", value<std::size_t>(&mer_count), "mers of the synthetic table")
+        ("read-file", value<std::string>(&read_file), "reads to score")
+        ("mer-file", value<std::string>(&mer_file), "mers to import");
+    positional_options_description positional;
+    positional.add("read-file", 1).add("mer-file", 1);
+    variables_map values;
+    try {
+        store(command_line_parser(argc, argv).options(options)
+                .positional(positional).run(), values);
+        notify(values);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl << options << std::endl;
+        return 1;
+    }
+
+    Suite suite(min_time);
+    std::srand(17);
+    std::cerr << "running" << std::endl;
+
+    /*
+     * parsing and the Read operations over the sample reads and over
+     * synthetic short and long reads
+     */
+    const std::vector<std::string> sample(load_sequences(read_file));
+    const double sample_bases(total_size(sample));
+    suite.run("fasta.reader/sample", sample.size(), sample_bases, [&]() {
+        FastaReader reader(read_file);
+        FastaReader::Record record;
+        while (reader.next(record)) {
+            sink = sink + record.sequence.size;
+        }
+    });
+    suite.run("fasta.items/sample", sample.size(), sample_bases, [&]() {
+        Fasta fasta(read_file);
+        while (!fasta.eof()) {
+            sink = sink + fasta.getItem().getRead().size();
+        }
+    });
+    bench_reads(suite, "sample", sample);
+
+    std::vector<std::string> short_reads, long_reads;
+    for (int i(0); i < 2000; i++) {
+        short_reads.push_back(random_sequence(150));
+    }
+    for (int i(0); i < 20; i++) {
+        long_reads.push_back(random_sequence(15000));
+    }
+    bench_reads(suite, "short", short_reads);
+    bench_reads(suite, "long", long_reads);
+
+    /*
+     * importing and scoring with the sample mers, and with a synthetic
+     * table of mers drawn from the synthetic reads
+     */
+    suite.run("filter.insertMers/sample", 1, 0., [&]() {
+        Filter filter(10, 20, 2.);
+        Fasta count(mer_file);
+        filter.insertMers(count);
+        sink = sink + filter.size();
+    });
+    Filter sample_filter(10, 20, 2.);
+    Fasta count(mer_file);
+    sample_filter.insertMers(count);
+    bench_filter(suite, "sample", sample_filter, sample);
+
+    std::vector<Read> synthetic_mers;
+    synthetic_mers.reserve(mer_count);
+    for (std::size_t i(0); i < mer_count; i++) {
+        const std::string& source(i % 2 == 0 ?
+                short_reads[(i / 2) % short_reads.size()] :
+                long_reads[(i / 2) % long_reads.size()]);
+        const std::size_t start(std::rand() % (source.size() - 25 + 1));
+        synthetic_mers.push_back(Read(source.substr(start, 25)));
+    }
+    Filter synthetic(10, 20, 2.);
+    suite.run("filter.insertMer/synthetic", synthetic_mers.size(),
+            synthetic_mers.size() * 25., [&]() {
+        Filter filter(10, 20, 2.);
+        for (std::size_t i(0); i < synthetic_mers.size(); i++) {
+            filter.insertMer(synthetic_mers[i], 5 + i % 60);
+        }
+        sink = sink + filter.size();
+        synthetic = std::move(filter);
+    });
+    bench_filter(suite, "synthetic-short", synthetic, short_reads);
+    bench_filter(suite, "synthetic-long", synthetic, long_reads);
+
+    if (values.count("json")) {
+        suite.printJson(std::cout);
+    } else {
+        suite.printText(std::cout);
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+// bloom_gate.cpp
+
+#include "bloom_gate.hpp"
+
+namespace carl {
+
+BloomGate::BloomGate() : _blocks(0) {
+}
+
+BloomGate::BloomGate(const size_type size, const unsigned int bits_per_mer) {
+    _blocks = (size * bits_per_mer + _block_words * 64 - 1) / (_block_words * 64);
+    if (_blocks == 0)
+        _blocks = 1;
+    // blocks are indexed by the upper 32 bits of the hash
+    if (_blocks > (size_type(1) << 32))
+        _blocks = size_type(1) << 32;
+    _words.assign(_blocks * _block_words, 0);
+}
+
+void BloomGate::insert(const mer_type key) {
+    if (_blocks == 0)
+        return;
+    const word_type hash(_hash(key));
+    word_type* block(&_words[_offset(hash)]);
+    word_type bits(hash * 0x9e3779b97f4a7c15ULL);
+    for (unsigned int i(0); i < _probes; i++, bits >>= 9) {
+        block[(bits >> 6) & 7] |= word_type(1) << (bits & 63);
+    }
+}
+
+} // carl
@@ -0,0 +1,79 @@
+// bloom_gate.hpp
+
+#ifndef __BLOOM_GATE_hpp
+#define __BLOOM_GATE_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mer.hpp"
+
+namespace carl {
+
+/*
+ * Blocked Bloom filter over packed k-mers, put in front of a mer table
+ * so that absent k-mers, the bulk of the k-mers of a read, are turned
+ * away before any probe of the table.
+ * Each k-mer sets its bits within one block of 512 bits picked by its
+ * hash, so a query reads a single cache line. At the default 16 bits
+ * per k-mer about 0.1% of absent k-mers get through.
+ * A gate only answers "maybe" or "no"; k-mers are never removed.
+ */
+class BloomGate {
+public:
+    typedef std::size_t size_type;
+
+private:
+    typedef std::uint64_t word_type;
+
+    static const unsigned int _block_words = 8;
+    static const unsigned int _probes = 7;
+
+    std::vector<word_type> _words;
+    size_type _blocks;
+
+    static word_type _hash(mer_type key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+    // first word of the block of a hash
+    size_type _offset(const word_type hash) const {
+        return ((hash >> 32) * _blocks >> 32) * _block_words;
+    }
+
+public:
+    BloomGate();
+    BloomGate(const size_type size, const unsigned int bits_per_mer = 16);
+    void insert(const mer_type key);
+    bool mayContain(const mer_type key) const {
+        if (_blocks == 0)
+            return true;
+        const word_type hash(_hash(key));
+        const word_type* block(&_words[_offset(hash)]);
+        // 9 bits per probe pick a bit of the block
+        word_type bits(hash * 0x9e3779b97f4a7c15ULL);
+        for (unsigned int i(0); i < _probes; i++, bits >>= 9) {
+            if (((block[(bits >> 6) & 7] >> (bits & 63)) & 1) == 0)
+                return false;
+        }
+        return true;
+    }
+    void prefetch(const mer_type key) const {
+        if (_blocks != 0)
+            __builtin_prefetch(&_words[_offset(_hash(key))]);
+    }
+    bool empty() const {
+        return _blocks == 0;
+    }
+    size_type memoryUsage() const {
+        return _words.size() * sizeof(word_type);
+    }
+};
+
+} // carl
+
+#endif
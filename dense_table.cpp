@@ -0,0 +1,98 @@
+// dense_table.cpp
+
+#include <limits>
+#include "dense_table.hpp"
+
+namespace carl {
+
+/*
+ * DenseTable::const_iterator
+ */
+DenseTable::const_iterator::const_iterator(const DenseTable* table, size_type index) :
+    _table(table), _index(index)
+{
+    _skip();
+}
+
+void DenseTable::const_iterator::_skip() {
+    while (_index < _table->capacity() && _table->_code(_index) == 0) {
+        _index++;
+    }
+}
+
+std::pair<mer_type, DenseTable::value_type>
+DenseTable::const_iterator::operator*() const {
+    return std::make_pair(mer_type(_index), _table->_codec.decode(_table->_code(_index)));
+}
+
+DenseTable::const_iterator& DenseTable::const_iterator::operator++() {
+    _index++;
+    _skip();
+    return *this;
+}
+
+/*
+ * DenseTable
+ */
+DenseTable::DenseTable() : _length(0), _size(0) {
+}
+
+DenseTable::DenseTable(const Read::size_type length, const ScoreCodec& codec) :
+    _codec(codec), _length(length), _values(memoryFor(length, codec), 0), _size(0)
+{
+}
+
+bool DenseTable::insert(const mer_type key, const value_type value) {
+    const ScoreCodec::code_type code(_codec.encode(value));
+    if (code == 0 || _code(key) != 0)
+        return false;
+    _store(key, code);
+    _size++;
+    return true;
+}
+
+// a key has one cell of its own, so only the size is shared
+bool DenseTable::insertShared(const mer_type key, const value_type value) {
+    const ScoreCodec::code_type code(_codec.encode(value));
+    if (code == 0 || _code(key) != 0)
+        return false;
+    _store(key, code);
+    __atomic_fetch_add(&_size, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+void DenseTable::_store(const mer_type key, const ScoreCodec::code_type code) {
+    switch (_codec.bytes()) {
+    case 1:
+        _values[key] = code;
+        break;
+    case 2:
+        reinterpret_cast<std::uint16_t*>(&_values[0])[key] = code;
+        break;
+    default:
+        reinterpret_cast<std::uint32_t*>(&_values[0])[key] = code;
+    }
+}
+
+double DenseTable::loadFactor() const {
+    if (capacity() == 0)
+        return 0.;
+    return double(_size) / capacity();
+}
+
+DenseTable::const_iterator DenseTable::begin() const {
+    return const_iterator(this, 0);
+}
+
+DenseTable::const_iterator DenseTable::end() const {
+    return const_iterator(this, capacity());
+}
+
+DenseTable::size_type DenseTable::memoryFor(const Read::size_type length,
+        const ScoreCodec& codec) {
+    if (length > max_length)
+        return std::numeric_limits<size_type>::max();
+    return (size_type(1) << (2 * length)) * codec.bytes();
+}
+
+} // carl
@@ -0,0 +1,106 @@
+// dense_table.hpp
+
+#ifndef __DENSE_TABLE_hpp
+#define __DENSE_TABLE_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "mer.hpp"
+#include "score_codec.hpp"
+
+namespace carl {
+
+/*
+ * Direct-address table from packed k-mers to scores for small k: one
+ * ScoreCodec code of 1, 2 or 4 bytes for each of the 4^k k-mers,
+ * indexed by the packed k-mer itself, so a lookup is a single load
+ * without hashing or probing.
+ * Code 0 marks an absent k-mer, so a score of 0 is not stored.
+ * find() never modifies the table and is safe to call from many
+ * threads, and so is insertShared() as long as each key is inserted by
+ * one thread only.
+ */
+class DenseTable {
+public:
+    typedef ScoreCodec::value_type value_type;
+    typedef std::size_t size_type;
+
+    class const_iterator {
+    private:
+        const DenseTable* _table;
+        size_type _index;
+        void _skip();
+    public:
+        const_iterator(const DenseTable* table, size_type index);
+        std::pair<mer_type, value_type> operator*() const;
+        const_iterator& operator++();
+        bool operator!=(const const_iterator& itr) const {
+            return _index != itr._index;
+        }
+    };
+
+    // longest k-mers a dense table is ever made for
+    static const Read::size_type max_length = 16;
+
+private:
+    ScoreCodec _codec;
+    Read::size_type _length;
+    std::vector<unsigned char> _values;
+    size_type _size;
+
+    ScoreCodec::code_type _code(const mer_type key) const {
+        switch (_codec.bytes()) {
+        case 1:
+            return _values[key];
+        case 2:
+            return reinterpret_cast<const std::uint16_t*>(&_values[0])[key];
+        default:
+            return reinterpret_cast<const std::uint32_t*>(&_values[0])[key];
+        }
+    }
+    void _store(const mer_type key, const ScoreCodec::code_type code);
+
+public:
+    DenseTable();
+    DenseTable(const Read::size_type length, const ScoreCodec& codec = ScoreCodec());
+    bool insert(const mer_type key, const value_type value);
+    bool insertShared(const mer_type key, const value_type value);
+    bool find(const mer_type key, value_type& value) const {
+        if (_values.empty())
+            return false;
+        const ScoreCodec::code_type code(_code(key));
+        if (code == 0)
+            return false;
+        value = _codec.decode(code);
+        return true;
+    }
+    void prefetch(const mer_type key) const {
+        if (!_values.empty())
+            __builtin_prefetch(&_values[key * _codec.bytes()]);
+    }
+    size_type size() const {
+        return _size;
+    }
+    // k-mers the table has room for, 4^k
+    size_type capacity() const {
+        return _values.size() / _codec.bytes();
+    }
+    Read::size_type merLength() const {
+        return _length;
+    }
+    const ScoreCodec& codec() const {
+        return _codec;
+    }
+    double loadFactor() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    // bytes of a dense table of k-mers of length with codec
+    static size_type memoryFor(const Read::size_type length, const ScoreCodec& codec);
+};
+
+} // carl
+
+#endif
@@ -2,8 +2,6 @@
 // written by S.Kato
 
 #include "fasta.hpp"
-#include <regex.h>
-#include <iostream>
 
 namespace carl {
 
@@ -36,18 +34,28 @@ const Read& Fasta::Item::getRead() const {
 /*
  * Fasta
  */
-Fasta::Fasta(const std::string& filename) : _filename(filename){
-    _ifs.open(_filename);
+Fasta::Fasta(const std::string& filename) :
+    _filename(filename), _begin(0), _end(~std::size_t(0)), _reader(filename),
+    _eof(false)
+{
     getItemStrings();
 }
 
-Fasta::Fasta(const Fasta& fasta) : _filename(fasta._filename){
-    _ifs.open(_filename);
+Fasta::Fasta(const std::string& filename, std::size_t begin, std::size_t end) :
+    _filename(filename), _begin(begin), _end(end), _reader(filename, begin, end),
+    _eof(false)
+{
+    getItemStrings();
+}
+
+Fasta::Fasta(const Fasta& fasta) :
+    _filename(fasta._filename), _begin(fasta._begin), _end(fasta._end),
+    _reader(fasta._filename, fasta._begin, fasta._end), _eof(false)
+{
     getItemStrings();
 }
 
 Fasta::~Fasta() {
-    _ifs.close();
 }
 
 Fasta::Item Fasta::getItem() {
@@ -57,41 +65,19 @@ Fasta::Item Fasta::getItem() {
 }
 
 std::pair<std::string, std::string> Fasta::getItemStrings() {
-    std::string info, sequence;
-    std::getline(_ifs, info);
-    std::getline(_ifs, sequence);
-
-    const char regex[] = "^>(.*)";
-    regex_t regexBuffer;
-
-    if (regcomp(&regexBuffer, regex, REG_EXTENDED | REG_NEWLINE) == 0) {
-        regmatch_t patternMatch[2];
-        int size = sizeof(patternMatch) / sizeof(regmatch_t);
-
-        if (regexec(&regexBuffer, info.c_str(), size, patternMatch, 0) == 0) {
-            int so = patternMatch[1].rm_so;
-            int eo = patternMatch[1].rm_eo;
-
-            try {
-                info = info.substr(so, eo-so);
-            } catch(const char* str) {
-                std::cerr << "Error in Fasta::getItemStrings()" << std::endl;
-                std::cerr << "\"info\": " << info << std::endl;
-                std::cerr << "\"so\": " << so << std::endl;
-                std::cerr << "\"eo\": " << eo << std::endl;
-                std::cerr << str << std::endl << std::endl;
-            }
-        }
-    }
-    regfree(&regexBuffer);
-
     std::pair<std::string, std::string> retval(_tmp);
-    _tmp = std::pair<std::string, std::string>(info, sequence);
+    FastaReader::Record record;
+    if (_reader.next(record)) {
+        _tmp = std::make_pair(record.info.str(), record.sequence.str());
+    } else {
+        _tmp = std::pair<std::string, std::string>();
+        _eof = true;
+    }
     return retval;
 }
 
 bool Fasta::eof() const {
-    return _ifs.eof();
+    return _eof;
 }
 
 } // carl
@@ -4,9 +4,9 @@
 #ifndef __FASTA_hpp
 #define __FASTA_hpp
 
-#include <fstream>
 #include <string>
 #include "read.hpp"
+#include "fasta_reader.hpp"
 
 namespace carl {
 
@@ -27,10 +27,14 @@ public:
 
 private:
     const std::string _filename;
-    std::ifstream _ifs;
+    const std::size_t _begin, _end;
+    FastaReader _reader;
     std::pair<std::string, std::string> _tmp;
+    bool _eof;
 public:
     Fasta(const std::string& filename);
+    // the records that start within [begin, end), see FastaReader
+    Fasta(const std::string& filename, std::size_t begin, std::size_t end);
     Fasta(const Fasta& fasta);
     ~Fasta();
     Item getItem();
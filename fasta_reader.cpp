@@ -0,0 +1,72 @@
+// fasta_reader.cpp
+
+#include "fasta_reader.hpp"
+#include <cstring>
+
+namespace carl {
+
+FastaReader::FastaReader(const std::string& filename) :
+    _file(filename), _offset(0), _end(_file.size())
+{
+    _file.adviseSequential();
+}
+
+FastaReader::FastaReader(const std::string& filename, std::size_t begin,
+        std::size_t end) :
+    _file(filename), _offset(_recordAt(begin)), _end(_recordAt(end))
+{
+    _file.adviseSequential();
+}
+
+/*
+ * the first record start at or after offset, the size of the file if
+ * there is none; offset 0 is always a record start
+ */
+std::size_t FastaReader::_recordAt(std::size_t offset) const {
+    const char* data(_file.data());
+    const std::size_t size(_file.size());
+    if (offset == 0)
+        return 0;
+    while (offset < size) {
+        if (data[offset - 1] == '\n' && data[offset] == '>')
+            return offset;
+        const char* end(static_cast<const char*>(
+                    std::memchr(data + offset, '\n', size - offset)));
+        if (end == NULL)
+            return size;
+        offset = end - data + 1;
+    }
+    return size;
+}
+
+FastaReader::Span FastaReader::_line() {
+    if (_offset >= _file.size())
+        return Span();
+    const char* begin(_file.data() + _offset);
+    const std::size_t rest(_file.size() - _offset);
+    const char* end(static_cast<const char*>(std::memchr(begin, '\n', rest)));
+    if (end == NULL) {
+        _offset = _file.size();
+        return Span(begin, rest);
+    }
+    _offset += end - begin + 1;
+    return Span(begin, end - begin);
+}
+
+bool FastaReader::next(Record& record) {
+    if (eof())
+        return false;
+    record.info = _line();
+    if (record.info.size > 0 && record.info.data[0] == '>') {
+        record.info.data++;
+        record.info.size--;
+    }
+    record.sequence = _line();
+    return true;
+}
+
+std::ostream& operator<<(std::ostream& os, const FastaReader::Span& span) {
+    return os.write(span.data, span.size);
+}
+
+} // carl
@@ -0,0 +1,68 @@
+// fasta_reader.hpp
+
+#ifndef __FASTA_READER_hpp
+#define __FASTA_READER_hpp
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include "mapped_file.hpp"
+
+namespace carl {
+
+/*
+ * Zero-copy reader of two-line FASTA records.
+ * The file is memory mapped and every record is handed out as a pair
+ * of views into the mapping, which stay valid as long as the reader.
+ * A reader may be limited to the records that start within a byte
+ * range; both ends move forward to the next line that starts with '>',
+ * so readers of adjacent ranges share out the records of the file
+ * without a pass over it beforehand.
+ */
+class FastaReader {
+public:
+    class Span {
+    public:
+        const char* data;
+        std::size_t size;
+
+        Span() : data(NULL), size(0) {
+        }
+        Span(const char* data, std::size_t size) : data(data), size(size) {
+        }
+        std::string str() const {
+            return std::string(data, size);
+        }
+    };
+
+    class Record {
+    public:
+        Span info;
+        Span sequence;
+    };
+
+private:
+    MappedFile _file;
+    std::size_t _offset;
+    std::size_t _end;
+
+    Span _line();
+    std::size_t _recordAt(std::size_t offset) const;
+
+public:
+    FastaReader(const std::string& filename);
+    FastaReader(const std::string& filename, std::size_t begin, std::size_t end);
+    bool next(Record& record);
+    bool eof() const {
+        return _offset >= _end;
+    }
+    const MappedFile& file() const {
+        return _file;
+    }
+};
+
+std::ostream& operator<<(std::ostream& os, const FastaReader::Span& span);
+
+} // carl
+
+#endif
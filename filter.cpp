@@ -1,18 +1,28 @@
 // filter.cpp
 // written by S.Kato
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <boost/thread.hpp>
 #include "filter.hpp"
 
 namespace carl {
 
-Filter::Filter(score_type lower_level, unsigned int lower_interval, double ratio) {
+const std::size_t Filter::default_dense_memory(std::size_t(64) << 20);
+
+Filter::Filter(score_type lower_level, unsigned int lower_interval, double ratio,
+        bool canonical, const ScoreCodec& codec, std::size_t dense_memory) :
+    _mer_table(codec), _dense_memory(dense_memory)
+{
     _mer_length = 0;
     _lower_level = lower_level;
     _default_score = 1;
     _lower_interval = lower_interval;
     _ratio = ratio;
+    _canonical = canonical;
+    _frozen = false;
 }
 
 Filter::Filter(const Filter& filter) {
@@ -21,19 +31,72 @@ Filter::Filter(const Filter& filter) {
     _default_score = 1;
     _lower_interval = filter._lower_interval;
     _ratio = filter._ratio;
+    _canonical = filter._canonical;
+    _frozen = filter._frozen;
 
+    _mer_table = filter._mer_table;
+    _dense_table = filter._dense_table;
+    _dense_memory = filter._dense_memory;
     _mer_map = filter._mer_map;
+    _frozen_index = filter._frozen_index;
+    _sorted_table = filter._sorted_table;
+    _gate = filter._gate;
 }
 
-Filter::Filter() {
+Filter::Filter(Filter&& filter) :
+    _mer_table(std::move(filter._mer_table)),
+    _dense_table(std::move(filter._dense_table)), _dense_memory(filter._dense_memory),
+    _mer_map(std::move(filter._mer_map)),
+    _frozen_index(std::move(filter._frozen_index)),
+    _sorted_table(std::move(filter._sorted_table)), _gate(std::move(filter._gate))
+{
+    _mer_length = filter._mer_length;
+    _lower_level = filter._lower_level;
+    _default_score = 1;
+    _lower_interval = filter._lower_interval;
+    _ratio = filter._ratio;
+    _canonical = filter._canonical;
+    _frozen = filter._frozen;
+}
+
+Filter::Filter() : _dense_memory(default_dense_memory) {
     _mer_length = 0;
     _lower_level = 0;
     _default_score = 1;
     _lower_interval = 0;
     _ratio = 0.;
+    _canonical = false;
+    _frozen = false;
+}
+
+Filter& Filter::operator=(const Filter& filter) {
+    if (this != &filter) {
+        Filter copy(filter);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+Filter& Filter::operator=(Filter&& filter) {
+    _mer_length = filter._mer_length;
+    _lower_level = filter._lower_level;
+    _lower_interval = filter._lower_interval;
+    _ratio = filter._ratio;
+    _canonical = filter._canonical;
+    _frozen = filter._frozen;
+    _mer_table = std::move(filter._mer_table);
+    _dense_table = std::move(filter._dense_table);
+    _dense_memory = filter._dense_memory;
+    _mer_map = std::move(filter._mer_map);
+    _frozen_index = std::move(filter._frozen_index);
+    _sorted_table = std::move(filter._sorted_table);
+    _gate = std::move(filter._gate);
+    return *this;
 }
 
-bool Filter::insertMer(const Read& read, score_type score) throw(MerLengthError) {
+bool Filter::insertMer(const Read& read, score_type score)
+        throw(MerLengthError, FrozenError) {
+    _checkMutable("Failed inserting " + read.tostring());
     if (!read.isDefinite())
         return false;
     if (this->_mer_length == 0) {
@@ -43,14 +106,42 @@ bool Filter::insertMer(const Read& read, score_type score) throw(MerLengthError)
         oss << _mer_length << " is not " << read.size();
         oss << ", Failed inserting " << read.tostring();
         throw MerLengthError(oss.str());
-    } else if (score <= this->_default_score) {
-        return false;
     }
+    if (score <= this->_default_score)
+        return false;
 
-    this->_mer_map.insert(map_type::value_type(read, score));
+    if (_isPacked()) {
+        mer_type mer(MerIterator::pack(read));
+        if (_canonical)
+            mer = carl::canonical(mer, _mer_length);
+        _insertPacked(mer, score);
+    } else if (this->_canonical) {
+        this->_mer_map.insert(map_type::value_type(_canonicalOf(read), score));
+    } else {
+        this->_mer_map.insert(map_type::value_type(read, score));
+    }
     return true;
 }
 
+/*
+ * makes the filter dense when the first packed mers are about to go in
+ * and a DenseTable of mers of this length fits in _dense_memory
+ */
+void Filter::_chooseTable() {
+    if (_isDense() || _mer_table.size() > 0 ||
+            DenseTable::memoryFor(_mer_length, codec()) > _dense_memory)
+        return;
+    _dense_table = DenseTable(_mer_length, codec());
+}
+
+bool Filter::_insertPacked(const mer_type mer, const score_type score) {
+    _chooseTable();
+    if (_isDense())
+        return _dense_table.insert(mer, score);
+    this->_gate.insert(mer);
+    return this->_mer_table.insert(mer, score);
+}
+
 bool Filter::insertMers(Fasta& fasta) {
     bool retval(false);
     while (!fasta.eof()) {
@@ -74,13 +165,201 @@ bool Filter::insertMers(Fasta& fasta) {
     return retval;
 }
 
-bool Filter::join(const Filter& filter) throw(MerLengthError, LowerLevelError) {
+bool Filter::importMers(const std::string& filename, const unsigned int num_thread) {
+    _checkMutable("Failed importing " + filename);
+    if (num_thread <= 1) {
+        Fasta fasta(filename);
+        return insertMers(fasta);
+    }
+    if (this->_mer_length == 0) {
+        this->_mer_length = _firstMerLength(filename);
+        if (this->_mer_length == 0)
+            return false;
+    }
+
+    std::vector<std::size_t> offsets;
+    const std::size_t size(MappedFile(filename).size());
+    for (unsigned int i(0); i <= num_thread; i++) {
+        offsets.push_back(size / num_thread * i + size % num_thread * i / num_thread);
+    }
+
+    boost::thread_group threads;
+    if (!_isPacked()) {
+        // long mers go to the map, which only takes one thread at a time
+        std::vector<Filter> filters(num_thread, Filter(_lower_level, _lower_interval,
+                    _ratio, _canonical, codec()));
+        for (unsigned int i(0); i < num_thread; i++) {
+            filters[i]._mer_length = _mer_length;
+            threads.create_thread([&filters, &filename, &offsets, i]() {
+                Fasta fasta(filename, offsets[i], offsets[i + 1]);
+                filters[i].insertMers(fasta);
+            });
+        }
+        threads.join_all();
+        const std::size_t before(_mer_map.size());
+        for (unsigned int i(0); i < num_thread; i++) {
+            join(filters[i]);
+        }
+        return _mer_map.size() > before;
+    }
+
+    /*
+     * entries[i][j] holds the mers parsed by thread i and owned by
+     * thread j; owners insert in file order, so the first of duplicate
+     * mers wins as it does on one thread
+     */
+    std::vector<std::vector<entry_list> > entries(num_thread,
+            std::vector<entry_list>(num_thread));
+    for (unsigned int i(0); i < num_thread; i++) {
+        threads.create_thread([this, &filename, &offsets, &entries, i]() {
+            _parseMers(filename, offsets[i], offsets[i + 1], entries[i]);
+        });
+    }
+    threads.join_all();
+
+    std::size_t total(0);
+    for (unsigned int i(0); i < num_thread; i++) {
+        for (unsigned int j(0); j < num_thread; j++) {
+            total += entries[i][j].size();
+        }
+    }
+    _chooseTable();
+    if (!_isDense()) {
+        _mer_table.reserveShared(_mer_table.size() + total);
+    }
+    std::vector<std::size_t> inserted(num_thread, 0);
+    boost::thread_group inserters;
+    for (unsigned int j(0); j < num_thread; j++) {
+        inserters.create_thread([this, &entries, &inserted, j]() {
+            inserted[j] = _insertShared(entries, j);
+        });
+    }
+    inserters.join_all();
+
+    // the gate is not safe to fill from many threads
+    if (!_gate.empty()) {
+        for (unsigned int i(0); i < num_thread; i++) {
+            for (unsigned int j(0); j < num_thread; j++) {
+                for (entry_list::const_iterator itr(entries[i][j].begin());
+                        itr != entries[i][j].end(); itr++) {
+                    _gate.insert(itr->first);
+                }
+            }
+        }
+    }
+    for (unsigned int j(0); j < num_thread; j++) {
+        if (inserted[j] > 0)
+            return true;
+    }
+    return false;
+}
+
+// the length of the first mer insertMers() would take
+Read::size_type Filter::_firstMerLength(const std::string& filename) const {
+    FastaReader reader(filename);
+    FastaReader::Record record;
+    while (reader.next(record)) {
+        try {
+            boost::lexical_cast<int>(record.info.str());
+        } catch(const boost::bad_lexical_cast& e) {
+            continue;
+        }
+        const Read read(record.sequence.data, record.sequence.size);
+        if (read.isDefinite())
+            return read.size();
+    }
+    return 0;
+}
+
+/*
+ * parses the records that start within [begin, end) and sorts their
+ * packed mers by owning thread, reporting bad records as insertMers()
+ * does
+ */
+void Filter::_parseMers(const std::string& filename, std::size_t begin,
+        std::size_t end, std::vector<entry_list>& entries) const {
+    FastaReader reader(filename, begin, end);
+    FastaReader::Record record;
+    while (reader.next(record)) {
+        const std::string str(record.info.str());
+        score_type score(0);
+        try {
+            score = boost::lexical_cast<int>(str);
+        } catch(const boost::bad_lexical_cast& e) {
+            std::cerr << e.what() << ", from \"" << str << "\" to <int>" << std::endl;
+            continue;
+        }
+        const Read read(record.sequence.data, record.sequence.size);
+        if (!read.isDefinite())
+            continue;
+        if (read.size() != _mer_length) {
+            std::ostringstream oss;
+            oss << _mer_length << " is not " << read.size();
+            oss << ", Failed inserting " << read.tostring();
+            std::cerr << MerLengthError(oss.str()).what() << std::endl;
+            continue;
+        }
+        if (score <= _default_score)
+            continue;
+        mer_type mer(MerIterator::pack(read));
+        if (_canonical)
+            mer = carl::canonical(mer, _mer_length);
+        // Fibonacci hashing, independent of the slot hash of the table
+        const std::size_t owner(((mer * 0x9e3779b97f4a7c15ULL) >> 32) % entries.size());
+        entries[owner].push_back(std::make_pair(mer, score));
+    }
+}
+
+std::size_t Filter::_insertShared(const std::vector<std::vector<entry_list> >& entries,
+        const std::size_t owner) {
+    std::size_t retval(0);
+    for (std::size_t i(0); i < entries.size(); i++) {
+        const entry_list& list(entries[i][owner]);
+        for (entry_list::const_iterator itr(list.begin()); itr != list.end(); itr++) {
+            retval += _isDense() ? _dense_table.insertShared(itr->first, itr->second) :
+                _mer_table.insertShared(itr->first, itr->second);
+        }
+    }
+    return retval;
+}
+
+/*
+ * takes the counts of a MerCounter as scores, emptying it; the mers are
+ * canonical, which a filter that is not finds all the same since it
+ * looks up the reverse complement of every window too
+ */
+bool Filter::insertCounts(MerCounter& counter)
+        throw(MerLengthError, FrozenError) {
+    _checkMutable("Failed inserting counted mers");
+    if (this->_mer_length == 0) {
+        this->_mer_length = counter.merLength();
+    } else if (counter.merLength() != this->_mer_length) {
+        std::ostringstream oss;
+        oss << counter.merLength() << " is not " << _mer_length;
+        oss << ", Failed inserting counted mers";
+        throw MerLengthError(oss.str());
+    }
+
+    bool retval(false);
+    counter.drain([&](const mer_type mer, const MerCounter::count_type count) {
+        if (count <= this->_default_score)
+            return;
+        _insertPacked(mer, count);
+        retval = true;
+    });
+    return retval;
+}
+
+bool Filter::join(const Filter& filter)
+        throw(MerLengthError, LowerLevelError, FrozenError) {
     if (filter._lower_level != this->_lower_level) {
         std::ostringstream oss;
         oss << filter._lower_level << " is not " << _lower_level;
         oss << ", Failed joining a filter instance" << std::flush;
         throw LowerLevelError(oss.str());
     }
+    _checkMutable("Failed joining a filter instance");
+    filter._checkMutable("Failed joining a filter instance");
     if (this->_mer_length == 0) {
         this->_mer_length = filter._mer_length;
     } else if (filter._mer_length != this->_mer_length) {
@@ -90,62 +369,452 @@ bool Filter::join(const Filter& filter) throw(MerLengthError, LowerLevelError) {
         throw MerLengthError(oss.str());
     }
 
-    this->_mer_map.insert(filter._mer_map.begin(), filter._mer_map.end());
+    const bool canonicalize(this->_canonical && !filter._canonical);
+    if (_isPacked()) {
+        _chooseTable();
+    }
+    if (!_isDense()) {
+        this->_mer_table.reserve(this->_mer_table.size() + filter._mer_table.size() +
+                filter._dense_table.size());
+    }
+    for (MerTable::const_iterator itr(filter._mer_table.begin());
+            itr != filter._mer_table.end(); ++itr) {
+        const std::pair<mer_type, score_type> entry(*itr);
+        _insertPacked(canonicalize ?
+                carl::canonical(entry.first, _mer_length) : entry.first, entry.second);
+    }
+    for (DenseTable::const_iterator itr(filter._dense_table.begin());
+            itr != filter._dense_table.end(); ++itr) {
+        const std::pair<mer_type, score_type> entry(*itr);
+        _insertPacked(canonicalize ?
+                carl::canonical(entry.first, _mer_length) : entry.first, entry.second);
+    }
+    if (canonicalize) {
+        for (map_type::const_iterator itr(filter._mer_map.begin());
+                itr != filter._mer_map.end(); itr++) {
+            this->_mer_map.insert(map_type::value_type(
+                        _canonicalOf((*itr).first), (*itr).second));
+        }
+    } else {
+        this->_mer_map.insert(filter._mer_map.begin(), filter._mer_map.end());
+    }
     return true;
 }
 
-std::vector<Filter::score_type> Filter::scores(const Read& read) const {
-    std::vector<score_type> retval;
-    const int length(read.size() - _mer_length + 1);
-    if (_mer_length == 0 || length <= 0) {
-        return retval;
+void Filter::writeDatabase(const std::string& filename) const {
+    if (!_isPacked()) {
+        std::ostringstream oss;
+        oss << "mers of " << _mer_length << " bases";
+        oss << ", Failed writing a database of up to " << max_packed_length;
+        throw MerLengthError(oss.str());
     }
-    for (int i(0); i < length; i++) {
-        const Read sub(read.sub(i, _mer_length));
-        if (!sub.isDefinite()) {
-            continue;
-        }
-        retval.push_back(_getScore(sub));
+    _checkMutable("Failed writing a database");
+    if (!_isDense()) {
+        MerDatabase::write(filename, _mer_table, _mer_length, _lower_level, _canonical);
+        return;
     }
-    return retval;
+    // databases hold hash tables, which map straight into memory
+    MerTable table(codec());
+    table.reserve(_dense_table.size());
+    for (DenseTable::const_iterator itr(_dense_table.begin());
+            itr != _dense_table.end(); ++itr) {
+        const std::pair<mer_type, score_type> entry(*itr);
+        table.insert(entry.first, entry.second);
+    }
+    MerDatabase::write(filename, table, _mer_length, _lower_level, _canonical);
 }
 
-bool Filter::check(std::vector<score_type> scores) const {
-    if (scores.size() == 0) {
-        return false;
+void Filter::loadDatabase(const std::string& filename, bool verify) {
+    const MerDatabase database(filename, verify);
+    _mer_table = database.table();
+    _dense_table = DenseTable();
+    _mer_map.clear();
+    _frozen_index = FrozenIndex();
+    _sorted_table = SortedTable();
+    _frozen = false;
+    _gate = BloomGate();
+    _mer_length = database.merLength();
+    _lower_level = database.lowerLevel();
+    _canonical = database.canonical();
+    if (DenseTable::memoryFor(_mer_length, codec()) > _dense_memory)
+        return;
+    // small mers are worth one pass over the mapping to be looked up directly
+    _dense_table = DenseTable(_mer_length, codec());
+    for (MerTable::const_iterator itr(database.table().begin());
+            itr != database.table().end(); ++itr) {
+        const std::pair<mer_type, score_type> entry(*itr);
+        _dense_table.insert(entry.first, entry.second);
     }
+    _mer_table = MerTable(codec());
+}
 
-    unsigned int lower_total(0), lower_count(0);
-    unsigned int upper_total(0), upper_count(0);
+void Filter::freeze() throw(MerLengthError) {
+    if (_frozen) {
+        return;
+    }
+    if (!_isPacked()) {
+        std::ostringstream oss;
+        oss << "mers of " << _mer_length << " bases";
+        oss << ", Failed freezing a table of up to " << max_packed_length;
+        throw MerLengthError(oss.str());
+    }
+    // a dense table is already as direct as it gets
+    if (_isDense()) {
+        _frozen = true;
+        return;
+    }
+    _frozen_index = FrozenIndex(_mer_table);
+    _mer_table = MerTable();
+    _frozen = true;
+}
 
-    for (std::vector<unsigned int>::const_iterator itr(scores.begin());
-            itr != scores.end(); itr++) {
-        if (*itr <= _lower_level) {
-            lower_count++;
-            lower_total += *itr;
+void Filter::sortTable() throw(MerLengthError, FrozenError) {
+    if (!_isPacked()) {
+        std::ostringstream oss;
+        oss << "mers of " << _mer_length << " bases";
+        oss << ", Failed sorting a table of up to " << max_packed_length;
+        throw MerLengthError(oss.str());
+    }
+    // a frozen index no longer knows its mers
+    _checkMutable("Failed sorting the table");
+    // a dense table is in order already
+    if (_isDense()) {
+        _frozen = true;
+        return;
+    }
+    entry_list entries;
+    entries.reserve(_mer_table.size());
+    for (MerTable::const_iterator itr(_mer_table.begin()); itr != _mer_table.end(); ++itr) {
+        entries.push_back(*itr);
+    }
+    _mer_table = MerTable(codec());
+    _sorted_table = SortedTable(entries, _mer_length);
+    _gate = BloomGate();
+    _frozen = true;
+}
+
+void Filter::buildGate(unsigned int bits_per_mer) throw(FrozenError) {
+    // a frozen filter no longer knows its mers
+    _checkMutable("Failed building a gate");
+    // a dense lookup is a single load already, and the map of long mers
+    // is not what the gate guards
+    if (_isDense() || !_isPacked())
+        return;
+    BloomGate gate(_mer_table.size(), bits_per_mer);
+    for (MerTable::const_iterator itr(_mer_table.begin());
+            itr != _mer_table.end(); ++itr) {
+        gate.insert((*itr).first);
+    }
+    _gate = std::move(gate);
+}
+
+namespace {
+
+/*
+ * The rule of Filter::check over a stream of scores: a run of lower
+ * scores shorter than the interval is forgotten when an upper score
+ * follows, although its scores stay in the lower total.
+ */
+class CheckRule {
+private:
+    const Filter::score_type _lower_level;
+    const unsigned int _lower_interval;
+    const double _ratio;
+    std::uint64_t _lower_total, _upper_total;
+    unsigned int _lower_count, _upper_count;
+    bool _empty;
+
+public:
+    CheckRule(const Filter::score_type lower_level,
+            const unsigned int lower_interval, const double ratio) :
+        _lower_level(lower_level), _lower_interval(lower_interval), _ratio(ratio),
+        _lower_total(0), _upper_total(0), _lower_count(0), _upper_count(0),
+        _empty(true)
+    {
+    }
+
+    void add(const Filter::score_type score) {
+        _empty = false;
+        if (score <= _lower_level) {
+            _lower_count++;
+            _lower_total += score;
         } else {
-            upper_count++;
-            upper_total += *itr;
-            if (lower_count < _lower_interval) {
-                lower_count = 0;
+            _upper_count++;
+            _upper_total += score;
+            if (_lower_count < _lower_interval) {
+                _lower_count = 0;
             }
         }
     }
 
-    if (upper_count == 0) {
+    /*
+     * whether the verdict is false whatever the at most remaining scores
+     * to come: once the lower run has reached the interval it is never
+     * reset, later upper scores (above the lower level) can only pull
+     * the upper average towards lower_level + 1 and later lower scores
+     * the lower average towards lower_level
+     */
+    bool rejected(const std::size_t remaining) const {
+        if (_upper_count == 0 || _lower_count == 0 ||
+                _lower_count < _lower_interval || _ratio < 0) {
+            return false;
+        }
+        const double upper_average(double(_upper_total) / _upper_count),
+                     lower_average(double(_lower_total) / _lower_count);
+        const double upper_min(std::min(upper_average,
+                    (_upper_total + remaining * (double(_lower_level) + 1)) /
+                    (_upper_count + remaining)));
+        const double lower_max(std::max(lower_average,
+                    (_lower_total + remaining * double(_lower_level)) /
+                    (_lower_count + remaining)));
+        return !(upper_min < lower_max * _ratio);
+    }
+
+    bool verdict() const {
+        if (_empty) {
+            return false;
+        }
+        if (_upper_count == 0) {
+            return true;
+        }
+        if (_lower_count < _lower_interval) {
+            return true;
+        }
+        const double upper_average(double(_upper_total)/_upper_count),
+                     lower_average(double(_lower_total)/_lower_count);
+        return upper_average < lower_average * _ratio;
+    }
+};
+
+} // anonymous
+
+/*
+ * Hands the score of every definite window of a read, in order, to
+ * consume(score, remaining), where remaining bounds the windows still to
+ * come; a false return stops the walk.
+ * Packed mers are walked by a FixedMerIterator of their length, one
+ * instance of the loop per length, and go through a ring of
+ * _prefetch_distance windows: each is prefetched when it enters and
+ * looked up when it leaves, so that many cache misses are in flight at
+ * once instead of one per window.
+ */
+template <class Consumer>
+void Filter::_forEachScore(const Read& read, Consumer& consume) const {
+    if (_mer_length == 0 || read.size() < _mer_length) {
+        return;
+    }
+    if (_isPacked()) {
+        _dispatchScores(read, consume,
+                std::integral_constant<Read::size_type, max_packed_length>());
+        return;
+    }
+    const std::size_t last(read.size() - _mer_length);
+    MerIterator itr(read, _mer_length);
+    while (itr.next()) {
+        if (!consume(score_type(_getScore(itr)), last - itr.position())) {
+            return;
+        }
+    }
+}
+
+template <Read::size_type K, class Consumer>
+void Filter::_dispatchScores(const Read& read, Consumer& consume,
+        std::integral_constant<Read::size_type, K>) const {
+    if (_mer_length == K) {
+        _forEachPackedScore<K>(read, consume);
+    } else {
+        _dispatchScores(read, consume, std::integral_constant<Read::size_type, K - 1>());
+    }
+}
+
+template <Read::size_type K, class Consumer>
+void Filter::_forEachPackedScore(const Read& read, Consumer& consume) const {
+    const std::size_t last(read.size() - K);
+    FixedMerIterator<K> itr(read);
+    const std::size_t mask(_prefetch_distance - 1);
+    mer_type forward[_prefetch_distance], reverse[_prefetch_distance];
+    std::size_t position[_prefetch_distance];
+    std::size_t head(0), count(0);
+    bool more(itr.next());
+    while (more || count > 0) {
+        if (more && count < _prefetch_distance) {
+            const std::size_t tail((head + count) & mask);
+            position[tail] = itr.position();
+            if (_canonical) {
+                forward[tail] = itr.canonical();
+            } else {
+                forward[tail] = itr.forward();
+                reverse[tail] = itr.reverse();
+                _prefetch(reverse[tail]);
+            }
+            _prefetch(forward[tail]);
+            count++;
+            more = itr.next();
+            continue;
+        }
+        score_type score;
+        const bool found(_find(forward[head], score) ||
+                (!_canonical && _find(reverse[head], score)));
+        if (!consume(found ? score : score_type(_default_score),
+                    last - position[head])) {
+            return;
+        }
+        head = (head + 1) & mask;
+        count--;
+    }
+}
+
+namespace {
+
+class ScoreList {
+public:
+    std::vector<Filter::score_type>& scores;
+    ScoreList(std::vector<Filter::score_type>& scores) : scores(scores) {
+    }
+    bool operator()(const Filter::score_type score, const std::size_t) {
+        scores.push_back(score);
         return true;
     }
-    if (lower_count < _lower_interval) {
+};
+
+// mers not in the table score default_score
+class CheckStream {
+public:
+    CheckRule rule;
+    bool rejected;
+    const Filter::score_type default_score;
+    Filter::Tally tally;
+    CheckStream(const CheckRule& rule, const Filter::score_type default_score) :
+        rule(rule), rejected(false), default_score(default_score)
+    {
+    }
+    bool operator()(const Filter::score_type score, const std::size_t remaining) {
+        tally.mers++;
+        tally.hits += score != default_score;
+        rule.add(score);
+        rejected = rule.rejected(remaining);
+        return !rejected;
+    }
+};
+
+class AverageStream {
+public:
+    double total;
+    const Filter::score_type default_score;
+    Filter::Tally tally;
+    AverageStream(const Filter::score_type default_score) :
+        total(0.), default_score(default_score)
+    {
+    }
+    bool operator()(const Filter::score_type score, const std::size_t) {
+        total += score;
+        tally.mers++;
+        tally.hits += score != default_score;
         return true;
     }
+};
+
+} // anonymous
 
-    const double upper_average(double(upper_total)/upper_count),
-                 lower_average(double(lower_total)/lower_count);
-    return upper_average < lower_average * _ratio;
+std::vector<Filter::score_type> Filter::scores(const Read& read) const {
+    std::vector<score_type> retval;
+    if (_mer_length == 0 || read.size() < _mer_length) {
+        return retval;
+    }
+    retval.reserve(read.size() - _mer_length + 1);
+    ScoreList list(retval);
+    _forEachScore(read, list);
+    return retval;
 }
 
-bool Filter::check(const Read& read) const {
-    return check(scores(read));
+namespace {
+
+// takes the scores a SortedTable sweep finds into the cells of the queries
+class CellWriter {
+public:
+    std::vector<Filter::score_type>& cells;
+    std::vector<unsigned char>& found;
+    CellWriter(std::vector<Filter::score_type>& cells, std::vector<unsigned char>& found) :
+        cells(cells), found(found)
+    {
+    }
+    void operator()(const std::pair<mer_type, std::size_t>& query,
+            const Filter::score_type score) {
+        cells[query.second] = score;
+        found[query.second] = 1;
+    }
+};
+
+} // anonymous
+
+/*
+ * On a sorted table, the mers of all the reads are collected with the
+ * cell their score goes to, two per window (forward and reverse) unless
+ * canonical, sorted, looked up in one sweep and scattered back per read.
+ * Other tables score one read after another.
+ */
+std::vector<std::vector<Filter::score_type> >
+Filter::scores(const std::vector<Read>& reads) const {
+    std::vector<std::vector<score_type> > retval(reads.size());
+    if (!_isSorted()) {
+        for (std::size_t i(0); i < reads.size(); i++) {
+            retval[i] = scores(reads[i]);
+        }
+        return retval;
+    }
+
+    std::vector<std::pair<mer_type, std::size_t> > queries;
+    // offsets[i] is the first window of read i
+    std::vector<std::size_t> offsets(1, 0);
+    offsets.reserve(reads.size() + 1);
+    for (std::size_t i(0); i < reads.size(); i++) {
+        std::size_t window(offsets.back());
+        MerIterator itr(reads[i], _mer_length);
+        while (itr.next()) {
+            if (_canonical) {
+                queries.push_back(std::make_pair(itr.canonical(), 2 * window));
+            } else {
+                queries.push_back(std::make_pair(itr.forward(), 2 * window));
+                queries.push_back(std::make_pair(itr.reverse(), 2 * window + 1));
+            }
+            window++;
+        }
+        offsets.push_back(window);
+    }
+    std::sort(queries.begin(), queries.end());
+
+    std::vector<score_type> cells(2 * offsets.back());
+    std::vector<unsigned char> found(2 * offsets.back(), 0);
+    CellWriter writer(cells, found);
+    _sorted_table.sweep(queries.begin(), queries.end(), writer);
+
+    for (std::size_t i(0); i < reads.size(); i++) {
+        retval[i].reserve(offsets[i + 1] - offsets[i]);
+        for (std::size_t cell(2 * offsets[i]); cell < 2 * offsets[i + 1]; cell += 2) {
+            retval[i].push_back(found[cell] ? cells[cell] :
+                    found[cell + 1] ? cells[cell + 1] : _default_score);
+        }
+    }
+    return retval;
+}
+
+bool Filter::check(std::vector<score_type> scores) const {
+    CheckRule rule(_lower_level, _lower_interval, _ratio);
+    for (std::vector<unsigned int>::const_iterator itr(scores.begin());
+            itr != scores.end(); itr++) {
+        rule.add(*itr);
+    }
+    return rule.verdict();
+}
+
+bool Filter::check(const Read& read, Tally* tally) const {
+    CheckStream stream(CheckRule(_lower_level, _lower_interval, _ratio), _default_score);
+    _forEachScore(read, stream);
+    if (tally != NULL) {
+        tally->mers += stream.tally.mers;
+        tally->hits += stream.tally.hits;
+    }
+    return !stream.rejected && stream.rule.verdict();
 }
 
 double Filter::average(std::vector<score_type> scores) const {
@@ -162,8 +831,28 @@ double Filter::average(std::vector<score_type> scores) const {
     return total/scores.size();
 }
 
-double Filter::average(const Read& read) const {
-    return average(scores(read));
+double Filter::average(const Read& read, Tally* tally) const {
+    AverageStream stream(_default_score);
+    _forEachScore(read, stream);
+    if (tally != NULL) {
+        tally->mers += stream.tally.mers;
+        tally->hits += stream.tally.hits;
+    }
+    if (stream.tally.mers == 0) {
+        return 0;
+    }
+    return stream.total/stream.tally.mers;
+}
+
+void Filter::_checkMutable(const std::string& what) const throw(FrozenError) {
+    if (_frozen) {
+        throw FrozenError("the filter is frozen, " + what);
+    }
+}
+
+Read Filter::_canonicalOf(const Read& read) const {
+    const Read comp(read.reverse().complement());
+    return comp < read ? comp : read;
 }
 
 int Filter::_getScore(const Read& read) const
@@ -174,6 +863,20 @@ int Filter::_getScore(const Read& read) const
         oss << ", Failed getting score of " << read.tostring();
         throw MerLengthError(oss.str());
     }
+    if (_isPacked()) {
+        MerIterator itr(read, _mer_length);
+        if (!itr.next()) {
+            return _default_score;
+        }
+        return _getScore(itr);
+    }
+    if (_canonical) {
+        map_type::const_iterator itr(_mer_map.find(_canonicalOf(read)));
+        if (itr != _mer_map.end()) {
+            return (*itr).second;
+        }
+        return _default_score;
+    }
     int score(0);
     map_type::const_iterator itr(_mer_map.find(read));
     if (itr != _mer_map.end()) {
@@ -189,4 +892,15 @@ int Filter::_getScore(const Read& read) const
     return score;
 }
 
+int Filter::_getScore(const MerIterator& itr) const {
+    if (!itr.isPacked()) {
+        return _getScore(itr.read());
+    }
+    score_type score;
+    const bool found(_canonical ?
+            _find(itr.canonical(), score) :
+            _find(itr.forward(), score) || _find(itr.reverse(), score));
+    return found ? int(score) : _default_score;
+}
+
 } // carl
@@ -6,14 +6,31 @@
 
 #include <string>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <boost/lexical_cast.hpp>
 #include <unordered_map>
 #include "read.hpp"
+#include "mer.hpp"
+#include "mer_table.hpp"
+#include "dense_table.hpp"
+#include "frozen_index.hpp"
+#include "sorted_table.hpp"
+#include "bloom_gate.hpp"
+#include "mer_database.hpp"
+#include "mer_counter.hpp"
 #include "fasta.hpp"
 
 namespace carl {
 
+/*
+ * k-mer scores of a mer table and the rules to accept reads by them.
+ * Mers of up to max_packed_length bases are packed into a hash table,
+ * or a DenseTable when k is small, which may be frozen into a read-only
+ * FrozenIndex or SortedTable; longer mers live in a map of Reads.
+ * The const members only read the table, so one Filter may be shared by
+ * any number of scoring threads while nothing modifies it.
+ */
 class Filter {
 public:
     class MerLengthError : public std::domain_error {
@@ -32,33 +49,183 @@ public:
         }
     };
 
-    typedef unsigned int score_type;
+    class FrozenError : public std::logic_error {
+    public:
+        FrozenError(const std::string& what_arg) :
+            std::logic_error::logic_error("FrozenError: " + what_arg)
+        {
+        }
+    };
+
+    typedef MerTable::value_type score_type;
+
+    static const std::size_t default_dense_memory;
+
+    // mers scored, and found in the table, by check() and average()
+    class Tally {
+    public:
+        std::size_t mers;
+        std::size_t hits;
+        Tally() : mers(0), hits(0) {
+        }
+    };
     typedef std::unordered_map<Read, score_type> map_type;
 
 private:
+    typedef std::vector<std::pair<mer_type, score_type> > entry_list;
+
+    // mers of up to max_packed_length bases live in _mer_table, or in
+    // _dense_table when it is small enough, longer ones fall back to _mer_map
+    MerTable _mer_table;
+    DenseTable _dense_table;
+    std::size_t _dense_memory;
     map_type _mer_map;
+    FrozenIndex _frozen_index;
+    SortedTable _sorted_table;
+    bool _frozen;
+    BloomGate _gate;
+    // a power of two
+    static const std::size_t _prefetch_distance = 16;
+
     Read::size_type  _mer_length;
     score_type _lower_level;
     score_type _default_score;
     unsigned int _lower_interval;
     double _ratio;
+    bool _canonical;
+    void _checkMutable(const std::string& what) const throw(FrozenError);
+    bool _isPacked() const {
+        return _mer_length > 0 && _mer_length <= max_packed_length;
+    }
+    bool _isDense() const {
+        return _dense_table.capacity() > 0;
+    }
+    bool _isSorted() const {
+        return !_sorted_table.empty();
+    }
+    void _chooseTable();
+    bool _insertPacked(const mer_type mer, const score_type score);
+    Read _canonicalOf(const Read& read) const;
+    Read::size_type _firstMerLength(const std::string& filename) const;
+    void _parseMers(const std::string& filename, std::size_t begin, std::size_t end,
+            std::vector<entry_list>& entries) const;
+    std::size_t _insertShared(const std::vector<std::vector<entry_list> >& entries,
+            const std::size_t owner);
     int _getScore(const Read& read) const
         throw(MerLengthError);
+    int _getScore(const MerIterator& itr) const;
+    void _prefetch(const mer_type mer) const {
+        if (_isDense()) {
+            _dense_table.prefetch(mer);
+            return;
+        }
+        _gate.prefetch(mer);
+        if (_isSorted())
+            return;
+        if (_frozen)
+            _frozen_index.prefetch(mer);
+        else
+            _mer_table.prefetch(mer);
+    }
+    template <class Consumer>
+    void _forEachScore(const Read& read, Consumer& consume) const;
+    // calls _forEachPackedScore<_mer_length>, trying K down to 1
+    template <Read::size_type K, class Consumer>
+    void _dispatchScores(const Read& read, Consumer& consume,
+            std::integral_constant<Read::size_type, K>) const;
+    template <class Consumer>
+    void _dispatchScores(const Read& read, Consumer& consume,
+            std::integral_constant<Read::size_type, 0>) const {
+    }
+    template <Read::size_type K, class Consumer>
+    void _forEachPackedScore(const Read& read, Consumer& consume) const;
+    bool _find(const mer_type mer, score_type& score) const {
+        if (_isDense())
+            return _dense_table.find(mer, score);
+        if (!_gate.mayContain(mer))
+            return false;
+        if (_frozen)
+            return _isSorted() ? _sorted_table.find(mer, score) :
+                _frozen_index.find(mer, score);
+        return _mer_table.find(mer, score);
+    }
 
 public:
-    Filter(score_type lower_level, unsigned int lower_interval, double ratio);
+    Filter(score_type lower_level, unsigned int lower_interval, double ratio,
+            bool canonical = false, const ScoreCodec& codec = ScoreCodec(),
+            std::size_t dense_memory = default_dense_memory);
     Filter(const Filter& filter);
+    Filter(Filter&& filter);
     Filter();
-    bool insertMer(const Read& read, score_type score) throw(MerLengthError);
+    Filter& operator=(const Filter& filter);
+    Filter& operator=(Filter&& filter);
+    bool insertMer(const Read& read, score_type score)
+        throw(MerLengthError, FrozenError);
     bool insertMers(Fasta& fasta);
-    bool join(const Filter& filter) throw(MerLengthError, LowerLevelError);
+    // parses byte ranges of the file on many threads, which then insert
+    // the mers they own by hash into the one table
+    bool importMers(const std::string& filename, unsigned int num_thread = 1);
+    bool insertCounts(MerCounter& counter)
+        throw(MerLengthError, FrozenError);
+    bool join(const Filter& filter)
+        throw(MerLengthError, LowerLevelError, FrozenError);
+    void writeDatabase(const std::string& filename) const;
+    // takes the mer length, lower level and canonical flag of the database
+    void loadDatabase(const std::string& filename, bool verify = false);
+    // trades the hash table for a FrozenIndex of a few bytes per mer; a
+    // dense table stays as it is
+    void freeze() throw(MerLengthError);
+    // freezes the table into a SortedTable, which scores(reads) sweeps
+    // once per batch
+    void sortTable() throw(MerLengthError, FrozenError);
+    // puts a BloomGate in front of hash lookups, and adds later mers to
+    // it; dense and long mers go without
+    void buildGate(unsigned int bits_per_mer = 16) throw(FrozenError);
     std::vector<score_type> scores(const Read& read) const;
+    std::vector<std::vector<score_type> > scores(const std::vector<Read>& reads) const;
     bool check(std::vector<score_type> scores) const;
-    bool check(const Read& read) const;
+    bool check(const Read& read, Tally* tally = NULL) const;
     double average(std::vector<score_type> scores) const;
-    double average(const Read& read) const;
+    double average(const Read& read, Tally* tally = NULL) const;
+    bool canonical() const {
+        return this->_canonical;
+    }
+    score_type lowerLevel() const {
+        return this->_lower_level;
+    }
+    const ScoreCodec& codec() const {
+        return this->_mer_table.codec();
+    }
+    bool frozen() const {
+        return this->_frozen;
+    }
+    bool gated() const {
+        return !this->_gate.empty();
+    }
+    bool dense() const {
+        return this->_isDense();
+    }
+    // whether the mers fit in a mer_type, which freeze() and sortTable() need
+    bool packed() const {
+        return this->_isPacked();
+    }
+    Read::size_type merLength() const {
+        return this->_mer_length;
+    }
+    bool sorted() const {
+        return this->_isSorted();
+    }
+    score_type defaultScore() const {
+        return this->_default_score;
+    }
+    double loadFactor() const {
+        return _isDense() ? this->_dense_table.loadFactor() :
+            this->_mer_table.loadFactor();
+    }
     int size() const {
-        return this->_mer_map.size();
+        return this->_mer_table.size() + this->_dense_table.size() +
+            this->_mer_map.size() + this->_frozen_index.size() +
+            this->_sorted_table.size();
     }
 };
 
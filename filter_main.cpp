@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <stdio.h>
+#include <unistd.h>
 #include <boost/lexical_cast.hpp>
+#include <boost/bind/bind.hpp>
 #include <boost/thread.hpp>
 #include <boost/program_options.hpp>
 #include <boost/uuid/uuid.hpp>
@@ -11,136 +16,314 @@
 #include <boost/uuid/uuid_io.hpp>
 
 #include "filter.hpp"
+#include "mapped_file.hpp"
+#include "pipeline.hpp"
+#include "stats.hpp"
 
 using namespace carl;
+using namespace boost::placeholders;
 
-void import_mer(const std::string mer_file, Filter& filter) {
-    Fasta mers(mer_file);
-    filter.insertMers(mers);
+/*
+ * what the scoring threads saw, for --stats
+ */
+class ScoreCounters {
+public:
+    std::atomic<std::size_t> records, bases, mers, hits;
+
+    ScoreCounters() : records(0), bases(0), mers(0), hits(0) {
+    }
+    void add(const FastaReader::Record& item, const Filter::Tally& tally) {
+        records++;
+        bases += item.sequence.size;
+        mers += tally.mers;
+        hits += tally.hits;
+    }
+    void report(Stats* stats) const {
+        if (stats == NULL)
+            return;
+        stats->setCounter("records", records);
+        stats->setCounter("bases", bases);
+        stats->setCounter("mers_scored", mers);
+        stats->setCounter("lookup_hits", hits);
+        stats->setCounter("lookup_misses", mers - hits);
+    }
+};
+
+void average(const FastaReader::Record& item, std::ostream& str,
+        const Filter& filter, ScoreCounters* counters) {
+    const Read read(item.sequence.data, item.sequence.size);
+    Filter::Tally tally;
+
+    if (read.size() == 0) {
+        if (counters != NULL)
+            counters->add(item, tally);
+        return;
+    }
+
+    const double average(filter.average(read, counters == NULL ? NULL : &tally));
+    if (counters != NULL)
+        counters->add(item, tally);
+    str << ">" << item.info << "\n";
+    str << average << "\n";
 }
 
-void average(const std::string infile, std::ostream& str, const Filter& filter) {
-    Fasta fasta(infile);
-    while (!fasta.eof()) {
-        const std::pair<std::string, std::string> item(fasta.getItemStrings());
-        const Read read(item.second);
+void check(const FastaReader::Record& item, std::ostream& str,
+        const Filter& filter, ScoreCounters* counters) {
+    const Read read(item.sequence.data, item.sequence.size);
+    Filter::Tally tally;
 
-        if (read.size() == 0)
-            continue;
+    if (read.size() == 0) {
+        if (counters != NULL)
+            counters->add(item, tally);
+        return;
+    }
 
-        const std::string info(item.first);
-        const double average(filter.average(read));
-        str << ">" << info << std::endl;
-        str << average << std::endl;
+    const bool accepted(filter.check(read, counters == NULL ? NULL : &tally));
+    if (counters != NULL)
+        counters->add(item, tally);
+    if (accepted) {
+        str << ">" << item.info << "\n";
+        str << item.sequence << "\n";
     }
 }
 
-void check(const std::string infile, std::ostream& str, const Filter& filter) {
-    Fasta fasta(infile);
-    while (!fasta.eof()) {
-        std::pair<std::string, std::string> item(fasta.getItemStrings());
-        Read read(item.second);
+void write_scores(const FastaReader::Record& item,
+        const std::vector<Filter::score_type>& scores, std::ostream& str,
+        const Filter& filter) {
+    str << ">" << item.info << "\n";
+    for (std::vector<Filter::score_type>::const_iterator itr(scores.begin());
+            itr != scores.end(); itr++) {
+        str << *itr << " ";
+    }
+    str << "\n";
+}
 
-        if (read.size() == 0)
-            continue;
+void output_scores(const FastaReader::Record& item, std::ostream& str,
+        const Filter& filter, ScoreCounters* counters) {
+    const Read read(item.sequence.data, item.sequence.size);
+    Filter::Tally tally;
 
-        if (filter.check(read)) {
-            std::string info = item.first;
-            std::string seq = item.second;
-            str << ">" << info << std::endl;
-            str << seq << std::endl;
-        }
+    if (read.size() == 0) {
+        if (counters != NULL)
+            counters->add(item, tally);
+        return;
+    }
+
+    std::vector<Filter::score_type> scores(filter.scores(read));
+    if (counters != NULL) {
+        tally.mers = scores.size();
+        tally.hits = scores.size() - std::count(scores.begin(), scores.end(),
+                filter.defaultScore());
+        counters->add(item, tally);
+    }
+    write_scores(item, scores, str, filter);
+}
+
+/*
+ * with --sorted, the reads of a batch are scored together in one sweep
+ * of the sorted table, then written out one by one by write
+ */
+typedef void (*write_type)(const FastaReader::Record&,
+        const std::vector<Filter::score_type>&, std::ostream&, const Filter&);
+
+void write_checked(const FastaReader::Record& item,
+        const std::vector<Filter::score_type>& scores, std::ostream& str,
+        const Filter& filter) {
+    if (filter.check(scores)) {
+        str << ">" << item.info << "\n";
+        str << item.sequence << "\n";
     }
 }
 
-void output_scores(const std::string infile, std::ostream& str, const Filter& filter) {
-    Fasta fasta(infile);
-    while (!fasta.eof()) {
-        std::pair<std::string, std::string> item(fasta.getItemStrings());
-        Read read(item.second);
-
-        if (read.size() == 0)
-            continue;
-
-        const std::string info(item.first);
-        std::vector<Filter::score_type> scores(filter.scores(read));
-        str << ">" << info << std::endl;
-        for (std::vector<Filter::score_type>::const_iterator itr(scores.begin());
-                itr != scores.end(); itr++) {
-            str << *itr << " ";
+void write_average(const FastaReader::Record& item,
+        const std::vector<Filter::score_type>& scores, std::ostream& str,
+        const Filter& filter) {
+    str << ">" << item.info << "\n";
+    str << filter.average(scores) << "\n";
+}
+
+void score_batch(const Pipeline::batch_type& batch, std::ostream& str,
+        const Filter& filter, write_type write, ScoreCounters* counters) {
+    std::vector<Read> reads;
+    reads.reserve(batch.size());
+    for (Pipeline::batch_type::const_iterator itr(batch.begin()); itr != batch.end(); itr++) {
+        reads.push_back(Read(itr->sequence.data, itr->sequence.size));
+    }
+    const std::vector<std::vector<Filter::score_type> > scores(filter.scores(reads));
+    for (std::size_t i(0); i < batch.size(); i++) {
+        if (counters != NULL) {
+            Filter::Tally tally;
+            tally.mers = scores[i].size();
+            tally.hits = scores[i].size() - std::count(scores[i].begin(),
+                    scores[i].end(), filter.defaultScore());
+            counters->add(batch[i], tally);
         }
-        str << std::endl;
+        if (reads[i].size() > 0)
+            write(batch[i], scores[i], str, filter);
     }
 }
 
+void report_output(const OutputWriter& writer, Stats* stats) {
+    if (stats != NULL) {
+        stats->addPhase("score.output", writer.seconds(), 0.);
+        stats->setCounter("output_bytes", writer.bytes());
+        stats->setCounter("output_writes", writer.calls());
+    }
+}
+
+void process_reads(const std::string& read_file,
+        const Pipeline::function_type& function, const unsigned int& cpub,
+        Stats* stats) {
+    Stats::Timer timer(stats, "score");
+    FastaReader fasta(read_file);
+    Pipeline pipeline(cpub);
+    OutputWriter writer(STDOUT_FILENO);
+    pipeline.run(fasta, function, writer);
+    writer.close();
+    report_output(writer, stats);
+}
+
+void process_batches(const std::string& read_file, const Filter& filter,
+        write_type write, const unsigned int& cpub, ScoreCounters* counters,
+        Stats* stats) {
+    Stats::Timer timer(stats, "score");
+    FastaReader fasta(read_file);
+    Pipeline pipeline(cpub);
+    OutputWriter writer(STDOUT_FILENO);
+    pipeline.runBatches(fasta, boost::bind(&score_batch, _1, _2, boost::cref(filter),
+                write, counters), writer);
+    writer.close();
+    report_output(writer, stats);
+}
+
 Filter import_mer_with_multi_thread(const std::string mers_file,
-        const Filter& parent, const int num_thread, const std::string identifier) {
+        const Filter& parent, const int num_thread, Stats* stats) {
     Filter retval(parent);
-    if (num_thread <= 1) {
-        import_mer(mers_file, retval);
+    Stats::Timer timer(stats, "import.parse");
+    retval.importMers(mers_file, num_thread);
+    return retval;
+}
+
+/*
+ * with --count, mers are counted from the reads of the mer file instead
+ * of imported from the output of a counter
+ */
+class Counting {
+public:
+    unsigned int length;    // 0 to import
+    std::size_t memory;     // bytes before partitions spill to disk, 0 for no limit
+};
+
+void count_mers(const std::string reads_file, Filter& filter, const int num_thread,
+        const std::string identifier, const Counting& counting, Stats* stats) {
+    MerCounter counter(counting.length, num_thread, counting.memory,
+            "/tmp/filter_count_" + identifier);
+    {
+        Stats::Timer timer(stats, "import.count");
+        FastaReader reader(reads_file);
+        counter.count(reader);
+    }
+    if (stats != NULL) {
+        stats->setCounter("counted_reads", counter.reads());
+        stats->setCounter("counted_mers", counter.mers());
+        stats->setCounter("count_spills", counter.spills());
+    }
+    Stats::Timer timer(stats, "import.merge");
+    filter.insertCounts(counter);
+}
+
+void report_table(const Filter& filter, Stats* stats) {
+    if (stats == NULL)
+        return;
+    stats->setCounter("table_mers", filter.size());
+    stats->setCounter("table_load_factor", filter.loadFactor());
+    stats->setCounter("table_dense", filter.dense() ? 1 : 0);
+}
+
+void load_mers(const std::string mers_file, Filter& filter,
+        const int num_thread, const std::string identifier, const bool verify_db,
+        const bool compact, const bool bloom, const bool sorted, const Counting& counting,
+        Stats* stats) {
+    if (counting.length > 0) {
+        count_mers(mers_file, filter, num_thread, identifier, counting, stats);
+    } else if (MerDatabase::isDatabase(mers_file)) {
+        Stats::Timer timer(stats, "import.database");
+        filter.loadDatabase(mers_file, verify_db);
     } else {
-        std::vector<std::string> filenames;
-        std::vector<Filter> filters;
-        filenames.reserve(num_thread);
-        filters.reserve(num_thread);
-
-        boost::thread_group threads;
-        std::ifstream ifs(mers_file);
-        std::string buff;
-        int lines(0);
-        while (ifs && getline(ifs, buff)) {
-            lines++;
-        }
-        lines /= 2;
-        ifs.close();
-
-        ifs.open(mers_file);
-        for (int i(0); i < num_thread; i++) {
-            std::ostringstream oss;
-            oss << "/tmp/filter_mer_split_" << identifier << "_" << i;
-            filenames.push_back(oss.str());
-
-            std::ofstream ofs(filenames.back());
-            for (int j(lines*i/num_thread); j < lines*(i+1)/num_thread; j++) {
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-            }
-            ofs.close();
-
-            filters.push_back(parent);
-            threads.create_thread(boost::bind(&import_mer, filenames.back(),
-                        std::ref(filters.back())));
-        }
-        ifs.close();
-        threads.join_all();
-
-        for (int i(0); i < num_thread; i++) {
-            try {
-                retval.join(filters.at(i));
-                remove(filenames.at(i).c_str());
-            } catch(const Filter::LowerLevelError& e) {
-                std::cerr << e.what() << std::endl;
-                std::ostringstream oss;
-                oss << "./not_imported_" << identifier << "_" << i << ".fasta";
-                rename(filenames.at(i).c_str(), oss.str().c_str());
-            } catch(const Filter::MerLengthError& e) {
-                std::cerr << e.what() << std::endl;
-                std::ostringstream oss;
-                oss << "./not_imported_" << identifier << "_" << i << ".fasta";
-                rename(filenames.at(i).c_str(), oss.str().c_str());
-            }
+        filter = import_mer_with_multi_thread(mers_file, filter, num_thread, stats);
+    }
+    report_table(filter, stats);
+    if (sorted && !filter.packed()) {
+        std::cerr << "warning: --sorted takes mers of up to " << max_packed_length
+            << " bases, scoring the " << filter.merLength() << "-mers from the hash table\n";
+    } else if (sorted) {
+        // the sorted table is frozen, so neither gate nor compaction apply
+        Stats::Timer timer(stats, "import.sort");
+        filter.sortTable();
+        return;
+    }
+    if (bloom) {
+        Stats::Timer timer(stats, "import.gate");
+        filter.buildGate();
+    }
+    if (compact && !filter.packed()) {
+        std::cerr << "warning: --compact takes mers of up to " << max_packed_length
+            << " bases, scoring the " << filter.merLength() << "-mers unfrozen\n";
+    } else if (compact) {
+        if (!bloom && !filter.dense()) {
+            std::cerr << "warning: --compact without --bloom scores about 1 in 65536 absent"
+                << " mers as present, which can change check verdicts\n";
         }
+        Stats::Timer timer(stats, "import.freeze");
+        filter.freeze();
     }
-    return retval;
+}
+
+/*
+ * a database keeps the lower level it was built with, and a filter
+ * loading it takes that level over, so checking reads needs the same -f
+ */
+bool check_lower_level(const std::string& mers_file, const unsigned int lower_level,
+        const Counting& counting) {
+    if (counting.length > 0 || !MerDatabase::isDatabase(mers_file))
+        return true;
+    const MerDatabase database(mers_file, false);
+    if (database.lowerLevel() == lower_level)
+        return true;
+    std::cerr << mers_file << " was built with -f " << database.lowerLevel()
+        << ", which checking reads against it needs as well" << std::endl;
+    return false;
+}
+
+void build_database(const std::string& db_file, const std::string& mers_file,
+        const unsigned int& lower_level, const unsigned int& cpua,
+        const bool& canonical, const ScoreCodec& codec, const std::size_t dense_memory,
+        const Counting& counting, Stats* stats) {
+
+    Filter filter(lower_level, 0, 0, canonical, codec, dense_memory);
+
+    boost::uuids::random_generator rng;
+    const boost::uuids::uuid id = rng();
+    const std::string identifier(boost::lexical_cast<std::string>(id));
+
+    if (counting.length > 0) {
+        count_mers(mers_file, filter, cpua, identifier, counting, stats);
+    } else {
+        filter = import_mer_with_multi_thread(mers_file, filter, cpua, stats);
+    }
+    report_table(filter, stats);
+    Stats::Timer timer(stats, "write_database");
+    filter.writeDatabase(db_file);
 }
 
 void filter(const std::string& read_file, const std::string& mers_file,
         const unsigned int& lower_level, const unsigned int& low_interval,
-        const double& ratio, const unsigned int& cpua, const unsigned int& cpub) {
+        const double& ratio, const unsigned int& cpua, const unsigned int& cpub,
+        const bool& canonical, const bool& verify_db, const bool& compact,
+        const bool& bloom, const bool& sorted, const ScoreCodec& codec,
+        const std::size_t dense_memory, const Counting& counting, Stats* stats) {
 
-    Filter filter(lower_level, low_interval, ratio);
+    Filter filter(lower_level, low_interval, ratio, canonical, codec, dense_memory);
 
     /*
      * Importing mer from a file */
@@ -148,77 +331,27 @@ void filter(const std::string& read_file, const std::string& mers_file,
     const boost::uuids::uuid id = rng();
     const std::string identifier(boost::lexical_cast<std::string>(id));
 
-    filter = import_mer_with_multi_thread(mers_file, filter, cpua, identifier);
+    load_mers(mers_file, filter, cpua, identifier, verify_db, compact, bloom, sorted,
+            counting, stats);
+    ScoreCounters counters;
 
-    if (cpub == 1) {
-        check(read_file, std::cout, filter);
+    if (sorted) {
+        process_batches(read_file, filter, &write_checked, cpub,
+                stats == NULL ? NULL : &counters, stats);
     } else {
-        std::vector<std::string> infiles;
-        std::vector<std::string> outfiles;
-        std::ofstream* ostreams = new std::ofstream[cpub];
-        std::vector<Filter> filters;
-        infiles.reserve(cpub);
-        outfiles.reserve(cpub);
-        filters.reserve(cpub);
-
-        boost::thread_group threads;
-        std::ifstream ifs(read_file);
-        std::string buff;
-        int lines(0);
-        while (ifs && getline(ifs, buff)) {
-            lines++;
-        }
-        lines /= 2;
-        ifs.close();
-
-        ifs.open(read_file);
-        for (unsigned int i(0); i < cpub; i++)
-        {
-            std::ostringstream ioss, ooss;
-            ioss << "/tmp/filter_read_splitb_" << identifier <<  "_" << i;
-            ooss << "/tmp/filter_read_split_out_" << identifier << "_" << i;
-            infiles.push_back(ioss.str());
-            outfiles.push_back(ooss.str());
-
-            std::ofstream ofs(infiles.back());
-            for (unsigned int j(lines*i/cpub); j < lines*(i+1)/cpub; j++) {
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-            }
-            ofs.close();
-
-            ostreams[i].open(outfiles.back().c_str());
-            filters.push_back(filter);
-            threads.create_thread(boost::bind(&check, infiles.back(),
-                        std::ref(ostreams[i]), std::ref(filters.back())));
-        }
-        ifs.close();
-        threads.join_all();
-
-        for (unsigned int i(0); i < cpub; i++) {
-            ostreams[i].close();
-            std::ifstream tmpifs(outfiles.at(i).c_str());
-            std::string buffer;
-            while (tmpifs && !tmpifs.eof()) {
-                if (getline(tmpifs, buffer)) {
-                    std::cout << buffer << std::endl;
-                }
-            }
-            tmpifs.close();
-            remove(infiles.at(i).c_str());
-            remove(outfiles.at(i).c_str());
-        }
-        delete[] ostreams;
+        process_reads(read_file, boost::bind(&check, _1, _2, boost::cref(filter),
+                    stats == NULL ? NULL : &counters), cpub, stats);
     }
-
+    counters.report(stats);
 }
 
 void calculate_average(const std::string& read_file, const std::string& mers_file,
-        const unsigned int& cpua, const unsigned int& cpub) {
+        const unsigned int& cpua, const unsigned int& cpub, const bool& canonical,
+        const bool& verify_db, const bool& compact, const bool& bloom,
+        const bool& sorted, const ScoreCodec& codec, const std::size_t dense_memory,
+        const Counting& counting, Stats* stats) {
 
-    Filter filter(1,0,0);
+    Filter filter(1,0,0,canonical,codec,dense_memory);
 
     /*
      * Importing mer from a file
@@ -227,75 +360,27 @@ void calculate_average(const std::string& read_file, const std::string& mers_fil
     const boost::uuids::uuid id = rng();
     const std::string identifier(boost::lexical_cast<std::string>(id));
 
-    filter = import_mer_with_multi_thread(mers_file, filter, cpua, identifier);
+    load_mers(mers_file, filter, cpua, identifier, verify_db, compact, bloom, sorted,
+            counting, stats);
+    ScoreCounters counters;
 
-    if (cpub == 1) {
-        average(read_file, std::cout, filter);
+    if (sorted) {
+        process_batches(read_file, filter, &write_average, cpub,
+                stats == NULL ? NULL : &counters, stats);
     } else {
-        std::vector<std::string> infiles, outfiles;
-        std::ofstream* ostreams = new std::ofstream[cpub];
-        std::vector<Filter> filters;
-        infiles.reserve(cpub);
-        outfiles.reserve(cpub);
-        filters.reserve(cpub);
-
-        boost::thread_group threads;
-        std::ifstream ifs(read_file);
-        std::string buff;
-        int lines(0);
-        while (ifs && getline(ifs, buff)) {
-            lines++;
-        }
-        lines /= 2;
-        ifs.close();
-
-        ifs.open(read_file);
-        for (unsigned int i(0); i < cpub; i++)
-        {
-            std::ostringstream ioss, ooss;
-            ioss << "/tmp/filter_read_splitb_" << identifier <<  "_" << i;
-            ooss << "/tmp/filter_read_split_out_" << identifier << "_" << i;
-            infiles.push_back(ioss.str());
-            outfiles.push_back(ooss.str());
-
-            std::ofstream ofs(infiles.back());
-            for (unsigned int j(lines*i/cpub); j < lines*(i+1)/cpub; j++) {
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-            }
-            ofs.close();
-
-            ostreams[i].open(outfiles.back().c_str());
-            filters.push_back(filter);
-            threads.create_thread(boost::bind(&average, infiles.back(),
-                        std::ref(ostreams[i]), std::ref(filters.back())));
-        }
-        ifs.close();
-        threads.join_all();
-
-        for (unsigned int i(0); i < cpub; i++) {
-            ostreams[i].close();
-            std::ifstream tmpifs(outfiles.at(i).c_str());
-            std::string buffer;
-            while (tmpifs && !tmpifs.eof()) {
-                if (getline(tmpifs, buffer)) {
-                    std::cout << buffer << std::endl;
-                }
-            }
-            tmpifs.close();
-            remove(infiles.at(i).c_str());
-            remove(outfiles.at(i).c_str());
-        }
-        delete[] ostreams;
+        process_reads(read_file, boost::bind(&average, _1, _2, boost::cref(filter),
+                    stats == NULL ? NULL : &counters), cpub, stats);
     }
+    counters.report(stats);
 }
 
 void list_scores(const std::string& read_file, const std::string& mers_file,
-        const unsigned int& cpua, const unsigned int& cpub) {
+        const unsigned int& cpua, const unsigned int& cpub, const bool& canonical,
+        const bool& verify_db, const bool& compact, const bool& bloom,
+        const bool& sorted, const ScoreCodec& codec, const std::size_t dense_memory,
+        const Counting& counting, Stats* stats) {
 
-    Filter filter(1,0,0);
+    Filter filter(1,0,0,canonical,codec,dense_memory);
 
     /*
      * Importing mer from a file
@@ -304,92 +389,75 @@ void list_scores(const std::string& read_file, const std::string& mers_file,
     const boost::uuids::uuid id = rng();
     const std::string identifier(boost::lexical_cast<std::string>(id));
 
-    filter = import_mer_with_multi_thread(mers_file, filter, cpua, identifier);
+    load_mers(mers_file, filter, cpua, identifier, verify_db, compact, bloom, sorted,
+            counting, stats);
+    ScoreCounters counters;
 
-    if (cpub == 1) {
-        output_scores(read_file, std::cout, filter);
+    if (sorted) {
+        process_batches(read_file, filter, &write_scores, cpub,
+                stats == NULL ? NULL : &counters, stats);
     } else {
-        std::vector<std::string> infiles, outfiles;
-        std::ofstream* ostreams = new std::ofstream[cpub];
-        std::vector<Filter> filters;
-        infiles.reserve(cpub);
-        outfiles.reserve(cpub);
-        filters.reserve(cpub);
-
-        boost::thread_group threads;
-        std::ifstream ifs(read_file);
-        std::string buff;
-        int lines(0);
-        while (ifs && getline(ifs, buff)) {
-            lines++;
-        }
-        lines /= 2;
-        ifs.close();
-
-        ifs.open(read_file);
-        for (unsigned int i(0); i < cpub; i++)
-        {
-            std::ostringstream ioss, ooss;
-            ioss << "/tmp/filter_read_splitb_" << identifier <<  "_" << i;
-            ooss << "/tmp/filter_read_split_out_" << identifier << "_" << i;
-            infiles.push_back(ioss.str());
-            outfiles.push_back(ooss.str());
-
-            std::ofstream ofs(infiles.back());
-            for (unsigned int j(lines*i/cpub); j < lines*(i+1)/cpub; j++) {
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-                getline(ifs, buff);
-                ofs << buff << std::endl;
-            }
-            ofs.close();
-
-            ostreams[i].open(outfiles.back().c_str());
-            filters.push_back(filter);
-            threads.create_thread(boost::bind(&output_scores, infiles.back(),
-                        std::ref(ostreams[i]), std::ref(filters.back())));
-        }
-        ifs.close();
-        threads.join_all();
-
-        for (unsigned int i(0); i < cpub; i++) {
-            ostreams[i].close();
-            std::ifstream tmpifs(outfiles.at(i).c_str());
-            std::string buffer;
-            while (tmpifs && !tmpifs.eof()) {
-                if (getline(tmpifs, buffer)) {
-                    std::cout << buffer << std::endl;
-                }
-            }
-            tmpifs.close();
-            remove(infiles.at(i).c_str());
-            remove(outfiles.at(i).c_str());
-        }
-        delete[] ostreams;
+        process_reads(read_file, boost::bind(&output_scores, _1, _2, boost::cref(filter),
+                    stats == NULL ? NULL : &counters), cpub, stats);
     }
+    counters.report(stats);
 }
 
 int main(int argc, char** argv) {
     std::string command(argv[0]);
-    std::string usage("usage: " + command + " read_file mer_file [options]");
+    std::string usage("usage: " + command + " read_file mer_file [options]\n" +
+            "       " + command + " db_file mer_file --build-db [options]\n" +
+            "       (with --count, mer_file holds the reads to count mers from)");
 
     unsigned int lower_level(0), low_interval(0);
     double ratio;
     unsigned int cpua(1), cpub(1);
+    unsigned int score_bits(32);
+    std::string stats_file;
+    Counting counting;
+    unsigned int count_memory(0);
+    unsigned int dense_memory(Filter::default_dense_memory >> 20);
     using namespace boost::program_options;
-    options_description options0(""), options1(""), options2("");
+    options_description options0(""), options1(""), options2(""), options3("");
     options0.add_options()
         (",f", value<unsigned int>(&lower_level), "lower_level")
         (",m", value<unsigned int>(&low_interval), "low_frequence")
         (",r", value<double>(&ratio), "ratio")
         (",a", value<unsigned int>(&cpua)->default_value(1), "threads for creating maps")
-        (",b", value<unsigned int>(&cpub)->default_value(1), "threads for calculating");
+        (",b", value<unsigned int>(&cpub)->default_value(1), "threads for calculating")
+        ("canonical", "store canonical mers (one lookup per mer)")
+        ("verify-db", "verify the checksum of a mer database before using it")
+        ("compact", "score from a minimal perfect hash index of a few bytes per mer"
+         " (an absent mer matches with probability 2^-16, which changes the scores"
+         " and check verdicts of a few reads; --bloom turns almost all of those away)")
+        ("bloom", "turn absent mers away with a Bloom filter before the table lookup")
+        ("sorted", "keep the mers sorted behind a radix index and score each batch of"
+         " reads with one sequential sweep of the table (ignores --compact, --bloom)")
+        ("score-bits", value<unsigned int>(&score_bits)->default_value(32),
+         "bits per stored score: 8, 16 or 32 (larger scores saturate, which"
+         " also lowers the averages -r compares; -f must stay below the largest)")
+        ("log-scores", "store scores of 8 or 16 bits on a log scale"
+         " (within 5.6% or 0.02% of the imported scores)")
+        ("count", value<unsigned int>(&counting.length)->default_value(0),
+         "count the canonical mers of this length (up to 32) in the reads of"
+         " mer_file, on -a threads, instead of importing counted mers")
+        ("count-memory", value<unsigned int>(&count_memory)->default_value(0),
+         "megabytes of counts to hold before spilling them to /tmp (0: no limit)")
+        ("dense-memory", value<unsigned int>(&dense_memory)->default_value(dense_memory),
+         "megabytes a direct-address table of every mer may take instead of a"
+         " hash table (0: always hash)")
+        ("stats", "report the time of each phase, counters and peak memory on stderr")
+        ("stats-json", value<std::string>(&stats_file),
+         "write the --stats report as JSON to this file");
     options1.add_options()
         ("average", "calculate average scores");
     options0.add(options1);
     options2.add_options()
         ("scores", "list mer scores");
     options0.add(options2);
+    options3.add_options()
+        ("build-db", "write the mers to a binary database at db_file");
+    options0.add(options3);
 
     if (argc < 3) {
         std::cerr << usage << std::endl;
@@ -404,12 +472,56 @@ int main(int argc, char** argv) {
     try {
         store(parse_command_line(argc, argv, options0), values);
         notify(values);
-        if (values.count("average")) {
-            calculate_average(read_file, mers_file, cpua, cpub);
+        const bool canonical(values.count("canonical") > 0);
+        const bool verify_db(values.count("verify-db") > 0);
+        const bool compact(values.count("compact") > 0);
+        const bool bloom(values.count("bloom") > 0);
+        const bool sorted(values.count("sorted") > 0);
+        const ScoreCodec codec(score_bits, values.count("log-scores") > 0 ?
+                ScoreCodec::Log : ScoreCodec::Linear);
+        if (!codec.keepsLevel(lower_level)) {
+            std::cerr << "scores of " << score_bits << " bits"
+                << (codec.mode() == ScoreCodec::Log ? " on a log scale" : "")
+                << " above " << codec.threshold() << " may come back as " << codec.threshold()
+                << ", which -f " << lower_level << " counts as lower; use more --score-bits"
+                << std::endl;
+            return 1;
+        }
+        counting.memory = std::size_t(count_memory) << 20;
+        if (counting.length == 0 && !MappedFile::isRegular(mers_file)) {
+            // it is sniffed for a database header, then read again by each shard
+            std::cerr << mers_file << " is not a regular file; mers cannot be imported"
+                << " from a pipe, only reads can" << std::endl;
+            return 1;
+        }
+        Stats report;
+        Stats* stats(values.count("stats") > 0 || !stats_file.empty() ? &report : NULL);
+        std::unique_ptr<Stats::Timer> total(new Stats::Timer(stats, "total"));
+        if (values.count("build-db")) {
+            build_database(read_file, mers_file, lower_level, cpua, canonical, codec,
+                    std::size_t(dense_memory) << 20, counting, stats);
+        } else if (values.count("average")) {
+            calculate_average(read_file, mers_file, cpua, cpub, canonical, verify_db,
+                    compact, bloom, sorted, codec, std::size_t(dense_memory) << 20,
+                    counting, stats);
         } else if(values.count("scores")) {
-            list_scores(read_file, mers_file, cpua, cpub);
+            list_scores(read_file, mers_file, cpua, cpub, canonical, verify_db,
+                    compact, bloom, sorted, codec, std::size_t(dense_memory) << 20,
+                    counting, stats);
+        } else if (!check_lower_level(mers_file, lower_level, counting)) {
+            return 1;
         } else {
-            filter(read_file, mers_file, lower_level, low_interval, ratio, cpua, cpub);
+            filter(read_file, mers_file, lower_level, low_interval, ratio, cpua, cpub,
+                    canonical, verify_db, compact, bloom, sorted, codec,
+                    std::size_t(dense_memory) << 20, counting, stats);
+        }
+        total.reset();
+        if (values.count("stats")) {
+            report.report(std::cerr);
+        }
+        if (!stats_file.empty()) {
+            std::ofstream ofs(stats_file);
+            report.writeJson(ofs);
         }
     } catch (std::exception &e) {
         std::cerr << e.what() << std::endl;
@@ -0,0 +1,141 @@
+// frozen_index.cpp
+
+#include <algorithm>
+#include "frozen_index.hpp"
+
+namespace carl {
+
+const FrozenIndex::size_type FrozenIndex::_npos(~FrozenIndex::size_type(0));
+const unsigned int FrozenIndex::_max_levels(32);
+const unsigned int FrozenIndex::_rank_block(8);
+
+FrozenIndex::FrozenIndex() : _score_width(1), _size(0) {
+}
+
+FrozenIndex::FrozenIndex(const MerTable& table) : _score_width(1), _size(0) {
+    std::vector<mer_type> keys;
+    keys.reserve(table.size());
+    value_type max_score(0);
+    for (MerTable::const_iterator itr(table.begin()); itr != table.end(); ++itr) {
+        const std::pair<mer_type, value_type> entry(*itr);
+        keys.push_back(entry.first);
+        max_score = std::max(max_score, entry.second);
+    }
+    _size = keys.size();
+
+    /*
+     * each level has two bits per remaining k-mer; the k-mers whose bit
+     * is hit more than once go on to the next level
+     */
+    for (unsigned int level(0); !keys.empty() && level < _max_levels; level++) {
+        const size_type words(std::max<size_type>(1, (keys.size() * 2 + 63) >> 6));
+        std::vector<word_type> seen(words, 0), collided(words, 0);
+        for (std::vector<mer_type>::const_iterator itr(keys.begin());
+                itr != keys.end(); itr++) {
+            const size_type bit(_reduce(_hash(*itr, level), words << 6));
+            const word_type mask(word_type(1) << (bit & 63));
+            if (seen[bit >> 6] & mask) {
+                collided[bit >> 6] |= mask;
+            } else {
+                seen[bit >> 6] |= mask;
+            }
+        }
+
+        Level entry;
+        entry.offset = _bits.size() << 6;
+        entry.size = words << 6;
+        _levels.push_back(entry);
+        for (size_type i(0); i < words; i++) {
+            _bits.push_back(seen[i] & ~collided[i]);
+        }
+
+        std::vector<mer_type>::iterator last(keys.begin());
+        for (std::vector<mer_type>::const_iterator itr(keys.begin());
+                itr != keys.end(); itr++) {
+            const size_type bit(_reduce(_hash(*itr, level), words << 6));
+            if ((collided[bit >> 6] >> (bit & 63)) & 1) {
+                *last++ = *itr;
+            }
+        }
+        keys.erase(last, keys.end());
+    }
+
+    size_type rank(0);
+    _ranks.reserve(_bits.size() / _rank_block + 1);
+    for (size_type i(0); i < _bits.size(); i++) {
+        if (i % _rank_block == 0) {
+            _ranks.push_back(rank);
+        }
+        rank += __builtin_popcountll(_bits[i]);
+    }
+    for (std::vector<mer_type>::const_iterator itr(keys.begin());
+            itr != keys.end(); itr++) {
+        _fallback[*itr] = rank++;
+    }
+
+    while (_score_width < 32 && (max_score >> _score_width) != 0) {
+        _score_width++;
+    }
+    _fingerprints.assign(_size, 0);
+    _scores.assign(((_size * _score_width + 63) >> 6) + 1, 0);
+    for (MerTable::const_iterator itr(table.begin()); itr != table.end(); ++itr) {
+        const std::pair<mer_type, value_type> entry(*itr);
+        const size_type slot(_slot(entry.first));
+        _fingerprints[slot] = _fingerprint(entry.first);
+
+        const size_type bit(slot * _score_width);
+        const unsigned int shift(bit & 63);
+        _scores[bit >> 6] |= word_type(entry.second) << shift;
+        if (shift + _score_width > 64) {
+            _scores[(bit >> 6) + 1] |= word_type(entry.second) >> (64 - shift);
+        }
+    }
+}
+
+FrozenIndex::size_type FrozenIndex::_rank(const size_type bit) const {
+    const size_type word(bit >> 6);
+    const size_type block(word / _rank_block);
+    size_type retval(_ranks[block]);
+    for (size_type i(block * _rank_block); i < word; i++) {
+        retval += __builtin_popcountll(_bits[i]);
+    }
+    const word_type below((word_type(1) << (bit & 63)) - 1);
+    return retval + __builtin_popcountll(_bits[word] & below);
+}
+
+FrozenIndex::size_type FrozenIndex::_slot(const mer_type key) const {
+    for (unsigned int level(0); level < _levels.size(); level++) {
+        const Level& entry(_levels[level]);
+        const size_type bit(entry.offset + _reduce(_hash(key, level), entry.size));
+        if (_test(bit)) {
+            return _rank(bit);
+        }
+    }
+    if (_fallback.empty()) {
+        return _npos;
+    }
+    const std::unordered_map<mer_type, size_type>::const_iterator
+        itr(_fallback.find(key));
+    return itr == _fallback.end() ? _npos : itr->second;
+}
+
+FrozenIndex::value_type FrozenIndex::_score(const size_type slot) const {
+    const size_type bit(slot * _score_width);
+    const unsigned int shift(bit & 63);
+    word_type retval(_scores[bit >> 6] >> shift);
+    if (shift + _score_width > 64) {
+        retval |= _scores[(bit >> 6) + 1] << (64 - shift);
+    }
+    return value_type(retval & ((word_type(1) << _score_width) - 1));
+}
+
+FrozenIndex::size_type FrozenIndex::memoryUsage() const {
+    return _levels.size() * sizeof(Level) +
+        _bits.size() * sizeof(word_type) +
+        _ranks.size() * sizeof(size_type) +
+        _fallback.size() * (sizeof(mer_type) + sizeof(size_type) + 2 * sizeof(void*)) +
+        _fingerprints.size() * sizeof(fingerprint_type) +
+        _scores.size() * sizeof(word_type);
+}
+
+} // carl
@@ -0,0 +1,115 @@
+// frozen_index.hpp
+
+#ifndef __FROZEN_INDEX_hpp
+#define __FROZEN_INDEX_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "mer.hpp"
+#include "mer_table.hpp"
+
+namespace carl {
+
+/*
+ * Read-only index from packed k-mers to scores, built once from a
+ * MerTable.
+ * A minimal perfect hash gives every stored k-mer its own slot in
+ * [0, size): a cascade of bit arrays, where a k-mer settles in the
+ * first level where no other remaining k-mer shares its bit, and the
+ * slot is the rank of that bit. The few k-mers left after the last level
+ * are kept in a small side map.
+ * Each slot holds a fingerprint of its k-mer, which rejects absent
+ * k-mers, and the score, bit-packed to the width of the largest one.
+ * The keys themselves are not stored: an absent k-mer is mistaken for
+ * the k-mer of its slot with probability 2^-fingerprint_bits.
+ */
+class FrozenIndex {
+public:
+    typedef MerTable::value_type value_type;
+    typedef std::size_t size_type;
+    typedef std::uint16_t fingerprint_type;
+
+    static const unsigned int fingerprint_bits = 16;
+
+private:
+    typedef std::uint64_t word_type;
+
+    class Level {
+    public:
+        size_type offset;   // first bit in _bits
+        size_type size;     // bits, a multiple of 64
+    };
+
+    static const size_type _npos;
+    static const unsigned int _max_levels;
+    static const unsigned int _rank_block;   // words per rank sample
+
+    std::vector<Level> _levels;
+    std::vector<word_type> _bits;
+    std::vector<size_type> _ranks;
+    std::unordered_map<mer_type, size_type> _fallback;
+    std::vector<fingerprint_type> _fingerprints;
+    std::vector<word_type> _scores;
+    unsigned int _score_width;
+    size_type _size;
+
+    static word_type _hash(mer_type key, const unsigned int level) {
+        key ^= (level + 1) * 0x9e3779b97f4a7c15ULL;
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+    // maps a hash onto [0, size) without a division
+    static size_type _reduce(const word_type hash, const size_type size) {
+        return size_type((static_cast<unsigned __int128>(hash) * size) >> 64);
+    }
+    static fingerprint_type _fingerprint(mer_type key) {
+        key *= 0xd6e8feb86659fd93ULL;
+        key ^= key >> 32;
+        key *= 0xd6e8feb86659fd93ULL;
+        return fingerprint_type(key >> (64 - fingerprint_bits));
+    }
+    bool _test(const size_type bit) const {
+        return (_bits[bit >> 6] >> (bit & 63)) & 1;
+    }
+    size_type _rank(const size_type bit) const;
+    size_type _slot(const mer_type key) const;
+    value_type _score(const size_type slot) const;
+
+public:
+    FrozenIndex();
+    FrozenIndex(const MerTable& table);
+    bool find(const mer_type key, value_type& value) const {
+        if (_size == 0)
+            return false;
+        const size_type slot(_slot(key));
+        if (slot == _npos || _fingerprints[slot] != _fingerprint(key))
+            return false;
+        value = _score(slot);
+        return true;
+    }
+    // pulls the bit of key in the first level towards the cache
+    void prefetch(const mer_type key) const {
+        if (_levels.empty())
+            return;
+        const size_type bit(_reduce(_hash(key, 0), _levels[0].size));
+        __builtin_prefetch(&_bits[bit >> 6]);
+    }
+    size_type size() const {
+        return _size;
+    }
+    unsigned int scoreWidth() const {
+        return _score_width;
+    }
+    // bytes held by the index
+    size_type memoryUsage() const;
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,95 @@
+// mapped_file.cpp
+
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace carl {
+
+MappedFile::MappedFile(const std::string& filename) throw(OpenError) :
+    _filename(filename), _data(NULL), _size(0), _mapped(false)
+{
+    const int fd(open(_filename.c_str(), O_RDONLY));
+    if (fd < 0) {
+        throw OpenError(_filename + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const int err(errno);
+        close(fd);
+        throw OpenError(_filename + ": " + std::strerror(err));
+    }
+    if (!S_ISREG(st.st_mode)) {
+        try {
+            _readAll(fd);
+        } catch (const OpenError&) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+        return;
+    }
+    _size = st.st_size;
+    if (_size > 0) {
+        void* addr(mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0));
+        if (addr == MAP_FAILED) {
+            const int err(errno);
+            close(fd);
+            throw OpenError(_filename + ": " + std::strerror(err));
+        }
+        _data = static_cast<const char*>(addr);
+        _mapped = true;
+    }
+    close(fd);
+}
+
+/*
+ * pipes and other streams have no size to map, so they are read to
+ * their end
+ */
+void MappedFile::_readAll(const int fd) throw(OpenError) {
+    const std::size_t chunk(1 << 20);
+    for (;;) {
+        _buffer.resize(_size + chunk);
+        const ssize_t count(read(fd, &_buffer[_size], chunk));
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            throw OpenError(_filename + ": " + std::strerror(errno));
+        }
+        if (count == 0)
+            break;
+        _size += count;
+    }
+    _buffer.resize(_size);
+    _data = _size > 0 ? &_buffer[0] : NULL;
+}
+
+MappedFile::~MappedFile() {
+    if (_mapped) {
+        munmap(const_cast<char*>(_data), _size);
+    }
+}
+
+void MappedFile::adviseSequential() const {
+    if (_mapped) {
+        madvise(const_cast<char*>(_data), _size, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::adviseRandom() const {
+    if (_mapped) {
+        madvise(const_cast<char*>(_data), _size, MADV_RANDOM);
+    }
+}
+
+bool MappedFile::isRegular(const std::string& filename) {
+    struct stat st;
+    return stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+} // carl
@@ -0,0 +1,63 @@
+// mapped_file.hpp
+
+#ifndef __MAPPED_FILE_hpp
+#define __MAPPED_FILE_hpp
+
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+namespace carl {
+
+/*
+ * Read-only memory mapping of a whole file.
+ * The mapping lives as long as the object; an empty file maps to
+ * a null pointer with size zero. A file that cannot be mapped, such as
+ * a pipe, is read into memory instead.
+ */
+class MappedFile {
+public:
+    class OpenError : public std::runtime_error {
+    public:
+        OpenError(const std::string& what_arg) :
+            std::runtime_error::runtime_error("OpenError: " + what_arg)
+        {
+        }
+    };
+
+private:
+    const std::string _filename;
+    const char* _data;
+    std::size_t _size;
+    bool _mapped;
+    std::vector<char> _buffer;  // the contents of a file that is not mapped
+
+    MappedFile(const MappedFile& file);
+    MappedFile& operator=(const MappedFile& file);
+    void _readAll(const int fd) throw(OpenError);
+
+public:
+    MappedFile(const std::string& filename) throw(OpenError);
+    ~MappedFile();
+    void adviseSequential() const;
+    void adviseRandom() const;
+    const char* data() const {
+        return _data;
+    }
+    std::size_t size() const {
+        return _size;
+    }
+    const std::string& filename() const {
+        return _filename;
+    }
+    bool mapped() const {
+        return _mapped;
+    }
+    // whether filename names a regular file, which can be opened again
+    static bool isRegular(const std::string& filename);
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,86 @@
+// mer.cpp
+
+#include "mer.hpp"
+
+namespace carl {
+
+namespace {
+
+// reverses the order of the 2-bit groups of a word
+inline mer_type reverse_pairs(mer_type x) {
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+} // anonymous
+
+mer_type mer_mask(const Read::size_type length) {
+    if (length >= max_packed_length)
+        return ~mer_type(0);
+    return (mer_type(1) << (length * 2)) - 1;
+}
+
+mer_type reverse_complement(const mer_type mer, const Read::size_type length) {
+    if (length == 0)
+        return 0;
+    return reverse_pairs(~mer) >> ((max_packed_length - length) * 2);
+}
+
+mer_type canonical(const mer_type mer, const Read::size_type length) {
+    const mer_type comp(reverse_complement(mer, length));
+    return mer < comp ? mer : comp;
+}
+
+MerIterator::MerIterator(const Read& read, const Read::size_type length) :
+    _sequence(read), _length(length), _mask(mer_mask(length)),
+    _next(0), _definite(0), _forward(0), _reverse(0)
+{
+}
+
+bool MerIterator::next() {
+    if (_length == 0)
+        return false;
+    while (_next < _sequence.size()) {
+        const Read::size_type i(_next++);
+        const unsigned char flg((_sequence._flgs[i >> 6] >> (i & 63)) & 1);
+        const unsigned char base((_sequence._read[i >> 5] >> ((i & 31) << 1)) & 3);
+        _forward = ((_forward << 2) | base) & _mask;
+        if (isPacked()) {
+            _reverse = (_reverse >> 2) |
+                (mer_type(base ^ 3) << ((_length - 1) << 1));
+        }
+        if (flg) {
+            _definite = 0;
+        } else if (_definite < _length) {
+            _definite++;
+        }
+        if (_definite == _length)
+            return true;
+    }
+    return false;
+}
+
+Read MerIterator::read() const {
+    if (isPacked())
+        return toRead(_forward, _length);
+    return _sequence.sub(position(), _length);
+}
+
+mer_type MerIterator::pack(const Read& read) {
+    MerIterator itr(read, read.size());
+    itr.next();
+    return itr.forward();
+}
+
+Read MerIterator::toRead(const mer_type mer, const Read::size_type length) {
+    Read retval(length);
+    if (length > 0) {
+        // the first base goes from the highest to the lowest bits
+        retval._read[0] = reverse_pairs(mer & mer_mask(length)) >>
+            ((max_packed_length - length) * 2);
+    }
+    return retval;
+}
+
+} // carl
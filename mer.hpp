@@ -0,0 +1,118 @@
+// mer.hpp
+
+#ifndef __MER_hpp
+#define __MER_hpp
+
+#include <cstdint>
+#include "read.hpp"
+
+namespace carl {
+
+/*
+ * A k-mer of up to 32 bases packed into one word, 2 bits per base,
+ * with the first base in the most significant position so that integer
+ * order matches lexicographic order of the sequence.
+ */
+typedef std::uint64_t mer_type;
+
+const Read::size_type max_packed_length = 32;
+
+mer_type mer_mask(const Read::size_type length);
+mer_type reverse_complement(const mer_type mer, const Read::size_type length);
+mer_type canonical(const mer_type mer, const Read::size_type length);
+
+/*
+ * Walks the windows of a Read from left to right, rolling the packed
+ * k-mer and its reverse complement forward by one base per step and
+ * skipping every window that covers an indefinite base.
+ */
+class MerIterator {
+private:
+    const Read& _sequence;
+    const Read::size_type _length;
+    const mer_type _mask;
+    Read::size_type _next;
+    Read::size_type _definite;
+    mer_type _forward;
+    mer_type _reverse;
+
+public:
+    MerIterator(const Read& read, const Read::size_type length);
+    // the iterator keeps a reference to the read, which must outlive it
+    MerIterator(Read&& read, const Read::size_type length) = delete;
+    bool next();
+    Read::size_type position() const {
+        return _next - _length;
+    }
+    mer_type forward() const {
+        return _forward;
+    }
+    mer_type reverse() const {
+        return _reverse;
+    }
+    mer_type canonical() const {
+        return _forward < _reverse ? _forward : _reverse;
+    }
+    bool isPacked() const {
+        return _length <= max_packed_length;
+    }
+    Read read() const;
+
+    static mer_type pack(const Read& read);
+    static Read toRead(const mer_type mer, const Read::size_type length);
+};
+
+/*
+ * A MerIterator over packed k-mers of a length K fixed at compile time:
+ * the mask and the shift of the reverse complement are constants, so
+ * the rolling update compiles to a few register operations per base.
+ */
+template <Read::size_type K>
+class FixedMerIterator {
+    static_assert(K > 0 && K <= max_packed_length, "K must fit in one mer_type");
+private:
+    static const mer_type _mask = ~mer_type(0) >> (2 * (max_packed_length - K));
+    static const Read::size_type _top = 2 * (K - 1);
+
+    const Read& _sequence;
+    Read::size_type _next;
+    Read::size_type _definite;
+    mer_type _forward;
+    mer_type _reverse;
+
+public:
+    explicit FixedMerIterator(const Read& read) :
+        _sequence(read), _next(0), _definite(0), _forward(0), _reverse(0)
+    {
+    }
+    explicit FixedMerIterator(Read&& read) = delete;
+    bool next() {
+        while (_next < _sequence._size) {
+            const Read::size_type i(_next++);
+            const unsigned char flg((_sequence._flgs[i >> 6] >> (i & 63)) & 1);
+            const unsigned char base((_sequence._read[i >> 5] >> ((i & 31) << 1)) & 3);
+            _forward = ((_forward << 2) | base) & _mask;
+            _reverse = (_reverse >> 2) | (mer_type(base ^ 3) << _top);
+            _definite = flg ? 0 : _definite + (_definite < K);
+            if (_definite == K)
+                return true;
+        }
+        return false;
+    }
+    Read::size_type position() const {
+        return _next - K;
+    }
+    mer_type forward() const {
+        return _forward;
+    }
+    mer_type reverse() const {
+        return _reverse;
+    }
+    mer_type canonical() const {
+        return _forward < _reverse ? _forward : _reverse;
+    }
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,289 @@
+// mer_counter.cpp
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <boost/bind/bind.hpp>
+#include "mer_counter.hpp"
+
+namespace carl {
+
+namespace {
+
+const mer_type empty_key(~mer_type(0));
+const MerCounter::count_type max_count(std::numeric_limits<MerCounter::count_type>::max());
+
+std::uint64_t mix(mer_type key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+} // anonymous
+
+/*
+ * One partition of the counts: an open-addressing table from canonical
+ * k-mers to counts. A canonical k-mer is never all ones (its reverse
+ * complement, all zeros, is smaller), so that word marks empty slots.
+ */
+class MerCounter::Partition {
+private:
+    static const size_type _min_capacity = 16;
+    static const size_type _slot_bytes = sizeof(mer_type) + sizeof(count_type);
+
+    std::vector<mer_type> _keys;
+    std::vector<count_type> _counts;
+    size_type _size;
+    size_type _mask;
+    const size_type _memory_limit;
+    const std::string _filename;
+    size_type _spills;
+    bool _on_disk;
+
+    void _rehash(const size_type capacity) {
+        std::vector<mer_type> keys(capacity, empty_key);
+        std::vector<count_type> counts(capacity, 0);
+        const size_type mask(capacity - 1);
+        for (size_type j(0); j < _keys.size(); j++) {
+            if (_keys[j] == empty_key)
+                continue;
+            size_type i(mix(_keys[j]) & mask);
+            while (keys[i] != empty_key) {
+                i = (i + 1) & mask;
+            }
+            keys[i] = _keys[j];
+            counts[i] = _counts[j];
+        }
+        _keys.swap(keys);
+        _counts.swap(counts);
+        _mask = mask;
+    }
+    void _spill() {
+        std::ofstream ofs(_filename.c_str(), std::ios::binary | std::ios::app);
+        for (size_type i(0); i < _keys.size() && ofs; i++) {
+            if (_keys[i] == empty_key)
+                continue;
+            ofs.write(reinterpret_cast<const char*>(&_keys[i]), sizeof(mer_type));
+            ofs.write(reinterpret_cast<const char*>(&_counts[i]), sizeof(count_type));
+        }
+        if (!ofs)
+            throw SpillError("Failed writing " + _filename);
+        std::fill(_keys.begin(), _keys.end(), empty_key);
+        _size = 0;
+        _spills++;
+        _on_disk = true;
+    }
+
+public:
+    boost::mutex mutex;
+
+    Partition(const size_type memory_limit, const std::string& filename) :
+        _size(0), _mask(0), _memory_limit(memory_limit), _filename(filename),
+        _spills(0), _on_disk(false)
+    {
+    }
+    ~Partition() {
+        if (_on_disk)
+            std::remove(_filename.c_str());
+    }
+    // spilling is only allowed while counting, not while merging spills back
+    void add(const mer_type mer, const count_type count, const bool may_spill) {
+        if ((_size + 1) * 4 > _keys.size() * 3) {
+            const size_type capacity(_keys.empty() ? _min_capacity : _keys.size() * 2);
+            if (may_spill && _memory_limit > 0 && !_keys.empty() &&
+                    capacity * _slot_bytes > _memory_limit) {
+                _spill();
+            } else {
+                _rehash(capacity);
+            }
+        }
+        for (size_type i(mix(mer) & _mask); ; i = (i + 1) & _mask) {
+            if (_keys[i] == mer) {
+                _counts[i] = _counts[i] > max_count - count ? max_count : _counts[i] + count;
+                return;
+            }
+            if (_keys[i] == empty_key) {
+                _keys[i] = mer;
+                _counts[i] = count;
+                _size++;
+                return;
+            }
+        }
+    }
+    size_type drain(const function_type& function) {
+        if (_on_disk) {
+            std::ifstream ifs(_filename.c_str(), std::ios::binary);
+            mer_type mer;
+            count_type count;
+            while (ifs.read(reinterpret_cast<char*>(&mer), sizeof(mer_type)) &&
+                    ifs.read(reinterpret_cast<char*>(&count), sizeof(count_type))) {
+                add(mer, count, false);
+            }
+            if (!ifs.eof())
+                throw SpillError("Failed reading " + _filename);
+            ifs.close();
+            std::remove(_filename.c_str());
+            _on_disk = false;
+        }
+        for (size_type i(0); i < _keys.size(); i++) {
+            if (_keys[i] != empty_key)
+                function(_keys[i], _counts[i]);
+        }
+        const size_type retval(_size);
+        std::vector<mer_type>().swap(_keys);
+        std::vector<count_type>().swap(_counts);
+        _size = 0;
+        _mask = 0;
+        return retval;
+    }
+    size_type spills() const {
+        return _spills;
+    }
+};
+
+const unsigned int MerCounter::_partition_bits(6);
+const MerCounter::size_type MerCounter::_buffer_size(4096);
+const MerCounter::size_type MerCounter::_batch_size(256);
+
+MerCounter::MerCounter(const Read::size_type length, const unsigned int num_thread,
+        const size_type memory_limit, const std::string& spill_prefix)
+    throw(MerLengthError) :
+    _length(length), _num_thread(num_thread > 0 ? num_thread : 1),
+    _memory_limit(memory_limit), _spill_prefix(spill_prefix), _reads(0), _mers(0)
+{
+    if (length == 0 || length > max_packed_length) {
+        std::ostringstream oss;
+        oss << "cannot count mers of " << length << " bases, only of 1 to "
+            << max_packed_length;
+        throw MerLengthError(oss.str());
+    }
+    const size_type partitions(size_type(1) << _partition_bits);
+    for (size_type i(0); i < partitions; i++) {
+        std::ostringstream oss;
+        oss << _spill_prefix << "_" << i;
+        _partitions.push_back(std::unique_ptr<Partition>(
+                    new Partition(_memory_limit / partitions, oss.str())));
+    }
+}
+
+MerCounter::~MerCounter() {
+}
+
+MerCounter::size_type MerCounter::_partitionOf(const mer_type mer) const {
+    return mix(mer) >> (64 - _partition_bits);
+}
+
+void MerCounter::count(FastaReader& reader) {
+    _error = std::exception_ptr();
+    if (_num_thread <= 1) {
+        _work(reader);
+    } else {
+        boost::thread_group threads;
+        for (unsigned int i(0); i < _num_thread; i++) {
+            threads.create_thread(boost::bind(&MerCounter::_work, this,
+                        boost::ref(reader)));
+        }
+        threads.join_all();
+    }
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+}
+
+void MerCounter::count(const Read& read) {
+    std::vector<std::vector<mer_type> > buffers(_partitions.size());
+    const size_type mers(_countRead(read, buffers));
+    for (size_type i(0); i < buffers.size(); i++) {
+        _flush(i, buffers[i]);
+    }
+    boost::lock_guard<boost::mutex> lock(_mutex);
+    _reads++;
+    _mers += mers;
+}
+
+void MerCounter::_work(FastaReader& reader) {
+    try {
+        std::vector<std::vector<mer_type> > buffers(_partitions.size());
+        std::vector<FastaReader::Record> batch(_batch_size);
+        size_type mers(0);
+        for (;;) {
+            size_type records(0);
+            {
+                boost::lock_guard<boost::mutex> lock(_mutex);
+                _mers += mers;
+                mers = 0;
+                if (_error)
+                    return;
+                while (records < _batch_size && reader.next(batch[records])) {
+                    records++;
+                }
+                _reads += records;
+            }
+            if (records == 0)
+                break;
+            for (size_type i(0); i < records; i++) {
+                const Read read(batch[i].sequence.data, batch[i].sequence.size);
+                mers += _countRead(read, buffers);
+            }
+        }
+        for (size_type i(0); i < buffers.size(); i++) {
+            _flush(i, buffers[i]);
+        }
+    } catch (...) {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (!_error)
+            _error = std::current_exception();
+    }
+}
+
+MerCounter::size_type MerCounter::_countRead(const Read& read,
+        std::vector<std::vector<mer_type> >& buffers) {
+    size_type mers(0);
+    MerIterator itr(read, _length);
+    while (itr.next()) {
+        const mer_type mer(itr.canonical());
+        const size_type partition(_partitionOf(mer));
+        buffers[partition].push_back(mer);
+        if (buffers[partition].size() >= _buffer_size) {
+            _flush(partition, buffers[partition]);
+        }
+        mers++;
+    }
+    return mers;
+}
+
+void MerCounter::_flush(const size_type partition, std::vector<mer_type>& buffer) {
+    if (buffer.empty())
+        return;
+    Partition& entry(*_partitions[partition]);
+    boost::lock_guard<boost::mutex> lock(entry.mutex);
+    for (std::vector<mer_type>::const_iterator itr(buffer.begin());
+            itr != buffer.end(); itr++) {
+        entry.add(*itr, 1, true);
+    }
+    buffer.clear();
+}
+
+MerCounter::size_type MerCounter::drain(const function_type& function) {
+    size_type retval(0);
+    for (size_type i(0); i < _partitions.size(); i++) {
+        boost::lock_guard<boost::mutex> lock(_partitions[i]->mutex);
+        retval += _partitions[i]->drain(function);
+    }
+    return retval;
+}
+
+MerCounter::size_type MerCounter::spills() const {
+    size_type retval(0);
+    for (size_type i(0); i < _partitions.size(); i++) {
+        retval += _partitions[i]->spills();
+    }
+    return retval;
+}
+
+} // carl
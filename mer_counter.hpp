@@ -0,0 +1,107 @@
+// mer_counter.hpp
+
+#ifndef __MER_COUNTER_hpp
+#define __MER_COUNTER_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include "fasta_reader.hpp"
+#include "mer.hpp"
+#include "read.hpp"
+
+namespace carl {
+
+/*
+ * Counts the canonical k-mers of FASTA reads on a pool of threads.
+ * The k-mers are split by hash into partitions, each an open-addressing
+ * table of its own under its own lock; a thread gathers the k-mers of
+ * its reads per partition and adds them a buffer at a time, so threads
+ * rarely wait on each other.
+ * With a memory limit, a partition that would outgrow its share of it
+ * appends its counts to a spill file and starts over empty. drain()
+ * merges the spill files back one partition at a time, so at most one
+ * whole partition is in memory at once.
+ */
+class MerCounter {
+public:
+    class MerLengthError : public std::domain_error {
+    public:
+        MerLengthError(const std::string& what_arg) :
+            std::domain_error::domain_error("MerLengthError: " + what_arg)
+        {
+        }
+    };
+
+    class SpillError : public std::runtime_error {
+    public:
+        SpillError(const std::string& what_arg) :
+            std::runtime_error::runtime_error("SpillError: " + what_arg)
+        {
+        }
+    };
+
+    typedef std::uint32_t count_type;
+    typedef std::size_t size_type;
+    typedef boost::function<void (mer_type, count_type)> function_type;
+
+private:
+    class Partition;
+
+    static const unsigned int _partition_bits;
+    static const size_type _buffer_size;   // k-mers gathered per partition
+    static const size_type _batch_size;    // records taken from the reader at once
+
+    const Read::size_type _length;
+    const unsigned int _num_thread;
+    const size_type _memory_limit;
+    const std::string _spill_prefix;
+    std::vector<std::unique_ptr<Partition> > _partitions;
+
+    boost::mutex _mutex;
+    std::exception_ptr _error;
+    size_type _reads;
+    size_type _mers;
+
+    size_type _partitionOf(const mer_type mer) const;
+    void _work(FastaReader& reader);
+    size_type _countRead(const Read& read, std::vector<std::vector<mer_type> >& buffers);
+    void _flush(const size_type partition, std::vector<mer_type>& buffer);
+
+public:
+    /*
+     * memory_limit is in bytes, 0 for none; spill files are named
+     * spill_prefix followed by the partition
+     */
+    MerCounter(const Read::size_type length, const unsigned int num_thread = 1,
+            const size_type memory_limit = 0,
+            const std::string& spill_prefix = "/tmp/carl_count")
+        throw(MerLengthError);
+    ~MerCounter();
+    void count(FastaReader& reader);
+    void count(const Read& read);
+    // calls function once per distinct k-mer and empties the counter
+    size_type drain(const function_type& function);
+    Read::size_type merLength() const {
+        return _length;
+    }
+    // records and k-mers counted so far
+    size_type reads() const {
+        return _reads;
+    }
+    size_type mers() const {
+        return _mers;
+    }
+    // times a partition went to disk
+    size_type spills() const;
+};
+
+} // carl
+
+#endif
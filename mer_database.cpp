@@ -0,0 +1,132 @@
+// mer_database.cpp
+
+#include "mer_database.hpp"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace carl {
+
+const char MerDatabase::magic[8] = {'C', 'A', 'R', 'L', 'M', 'E', 'R', 'S'};
+const std::uint32_t MerDatabase::version = 2;
+
+MerDatabase::MerDatabase(const std::string& filename, bool verify) :
+    _file(new MappedFile(filename))
+{
+    if (_file->size() < sizeof(Header)) {
+        throw FormatError(filename + ": too short for a mer database");
+    }
+    std::memcpy(&_header, _file->data(), sizeof(Header));
+    if (std::memcmp(_header.magic, magic, sizeof(magic)) != 0) {
+        throw FormatError(filename + ": not a mer database");
+    }
+    if (_header.version != version) {
+        std::ostringstream oss;
+        oss << filename << ": version " << _header.version << " is not " << version;
+        throw FormatError(oss.str());
+    }
+    if (_header.header_checksum != _headerChecksum(_header)) {
+        throw FormatError(filename + ": broken header");
+    }
+    try {
+        _table._codec = ScoreCodec(_header.score_bits,
+                ScoreCodec::Mode(_header.score_mode));
+    } catch (const ScoreCodec::ScoreBitsError& e) {
+        throw FormatError(filename + ": " + e.what());
+    }
+    const std::uint64_t capacity(_header.capacity);
+    if ((capacity & (capacity - 1)) != 0 ||
+            _header.mer_length == 0 || _header.mer_length > max_packed_length ||
+            _header.score_mode > ScoreCodec::Log ||
+            _file->size() != sizeof(Header) +
+            capacity * (sizeof(mer_type) + _table._codec.bytes())) {
+        throw FormatError(filename + ": inconsistent header");
+    }
+
+    const char* data(_file->data() + sizeof(Header));
+    const std::size_t keys_size(capacity * sizeof(mer_type));
+    const std::size_t values_size(capacity * _table._codec.bytes());
+    if (verify && _checksum(data + keys_size, values_size,
+                _checksum(data, keys_size, 0)) != _header.data_checksum) {
+        throw FormatError(filename + ": checksum mismatch");
+    }
+    _file->adviseRandom();
+
+    _table._file = _file;
+    _table._key_data = reinterpret_cast<const mer_type*>(data);
+    _table._value_data = reinterpret_cast<const unsigned char*>(data + keys_size);
+    _table._capacity = capacity;
+    _table._mask = capacity == 0 ? 0 : capacity - 1;
+    _table._size = _header.size;
+    _table._has_empty_key = _header.has_empty_key != 0;
+    _table._empty_key_value = _header.empty_key_value;
+}
+
+bool MerDatabase::isDatabase(const std::string& filename) {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    char buff[sizeof(magic)];
+    if (!ifs.read(buff, sizeof(buff)))
+        return false;
+    return std::memcmp(buff, magic, sizeof(magic)) == 0;
+}
+
+void MerDatabase::write(const std::string& filename, const MerTable& table,
+        const Read::size_type mer_length, const unsigned int lower_level,
+        const bool canonical) {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.mer_length = mer_length;
+    header.lower_level = lower_level;
+    header.canonical = canonical ? 1 : 0;
+    header.score_bits = table.codec().bits();
+    header.score_mode = table.codec().mode();
+    header.has_empty_key = table._has_empty_key ? 1 : 0;
+    header.empty_key_value = table._has_empty_key ? table._empty_key_value : 0;
+    header.size = table.size();
+    header.capacity = table.capacity();
+
+    const std::size_t keys_size(table.capacity() * sizeof(mer_type));
+    const std::size_t values_size(table.capacity() * table.codec().bytes());
+    header.data_checksum = _checksum(table._value_data, values_size,
+            _checksum(table._key_data, keys_size, 0));
+    header.header_checksum = _headerChecksum(header);
+
+    std::ofstream ofs(filename.c_str(), std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (table.capacity() > 0) {
+        ofs.write(reinterpret_cast<const char*>(table._key_data), keys_size);
+        ofs.write(reinterpret_cast<const char*>(table._value_data), values_size);
+    }
+    ofs.close();
+    if (!ofs) {
+        throw WriteError("Failed writing " + filename);
+    }
+}
+
+std::uint64_t MerDatabase::_checksum(const void* data, std::size_t size,
+        std::uint64_t seed) {
+    // FNV-1a over 64-bit words, then over the remaining bytes
+    const std::uint64_t prime(0x100000001b3ULL);
+    std::uint64_t h(seed ^ 0xcbf29ce484222325ULL);
+    const char* bytes(static_cast<const char*>(data));
+    std::size_t i(0);
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        h = (h ^ word) * prime;
+    }
+    for (; i < size; i++) {
+        h = (h ^ static_cast<unsigned char>(bytes[i])) * prime;
+    }
+    return h;
+}
+
+std::uint64_t MerDatabase::_headerChecksum(const Header& header) {
+    Header copy(header);
+    copy.header_checksum = 0;
+    return _checksum(&copy, sizeof(copy), 0);
+}
+
+} // carl
@@ -0,0 +1,91 @@
+// mer_database.hpp
+
+#ifndef __MER_DATABASE_hpp
+#define __MER_DATABASE_hpp
+
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <memory>
+#include "mer_table.hpp"
+#include "mapped_file.hpp"
+
+namespace carl {
+
+/*
+ * Binary mer table on disk.
+ * The file is a fixed header followed by the key and value arrays of a
+ * MerTable exactly as they are laid out in memory, so opening it is a
+ * single mmap and lookups fault pages in on demand.
+ */
+class MerDatabase {
+public:
+    class FormatError : public std::runtime_error {
+    public:
+        FormatError(const std::string& what_arg) :
+            std::runtime_error::runtime_error("FormatError: " + what_arg)
+        {
+        }
+    };
+
+    class WriteError : public std::runtime_error {
+    public:
+        WriteError(const std::string& what_arg) :
+            std::runtime_error::runtime_error("WriteError: " + what_arg)
+        {
+        }
+    };
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t mer_length;
+        std::uint32_t lower_level;
+        std::uint32_t canonical;
+        std::uint32_t score_bits;
+        std::uint32_t score_mode;
+        std::uint32_t has_empty_key;
+        std::uint32_t reserved;
+        std::uint64_t empty_key_value;
+        std::uint64_t size;
+        std::uint64_t capacity;
+        std::uint64_t data_checksum;
+        std::uint64_t header_checksum;
+    };
+
+    static const char magic[8];
+    static const std::uint32_t version;
+
+private:
+    std::shared_ptr<const MappedFile> _file;
+    Header _header;
+    MerTable _table;
+
+    static std::uint64_t _checksum(const void* data, std::size_t size,
+            std::uint64_t seed);
+    static std::uint64_t _headerChecksum(const Header& header);
+
+public:
+    MerDatabase(const std::string& filename, bool verify);
+    Read::size_type merLength() const {
+        return _header.mer_length;
+    }
+    unsigned int lowerLevel() const {
+        return _header.lower_level;
+    }
+    bool canonical() const {
+        return _header.canonical != 0;
+    }
+    const MerTable& table() const {
+        return _table;
+    }
+
+    static bool isDatabase(const std::string& filename);
+    static void write(const std::string& filename, const MerTable& table,
+            const Read::size_type mer_length, const unsigned int lower_level,
+            const bool canonical);
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,248 @@
+// mer_table.cpp
+
+#include <algorithm>
+#include "mer_table.hpp"
+
+namespace carl {
+
+const mer_type MerTable::empty_key = ~mer_type(0);
+const MerTable::size_type MerTable::_min_capacity = 16;
+
+/*
+ * MerTable::const_iterator
+ */
+MerTable::const_iterator::const_iterator(const MerTable* table, size_type index) :
+    _table(table), _index(index)
+{
+    _skip();
+}
+
+void MerTable::const_iterator::_skip() {
+    // index capacity() stands for the entry of the empty key
+    while (_index < _table->capacity() &&
+            _table->_key_data[_index] == MerTable::empty_key) {
+        _index++;
+    }
+    if (_index == _table->capacity() && !_table->_has_empty_key) {
+        _index++;
+    }
+}
+
+std::pair<mer_type, MerTable::value_type>
+MerTable::const_iterator::operator*() const {
+    if (_index == _table->capacity()) {
+        return std::make_pair(MerTable::empty_key, _table->_empty_key_value);
+    }
+    return std::make_pair(_table->_key_data[_index],
+            _table->_codec.decode(_table->_code(_index)));
+}
+
+MerTable::const_iterator& MerTable::const_iterator::operator++() {
+    _index++;
+    _skip();
+    return *this;
+}
+
+/*
+ * MerTable
+ */
+MerTable::MerTable(const ScoreCodec& codec) :
+    _codec(codec), _key_data(NULL), _value_data(NULL), _capacity(0),
+    _size(0), _mask(0), _has_empty_key(false), _empty_key_value(0)
+{
+}
+
+MerTable::MerTable(const MerTable& table) :
+    _codec(table._codec), _keys(table._keys), _values(table._values), _file(table._file),
+    _key_data(table._key_data), _value_data(table._value_data),
+    _capacity(table._capacity), _size(table._size), _mask(table._mask),
+    _has_empty_key(table._has_empty_key),
+    _empty_key_value(table._empty_key_value)
+{
+    _bind();
+}
+
+MerTable::MerTable(MerTable&& table) :
+    _codec(table._codec), _keys(std::move(table._keys)), _values(std::move(table._values)),
+    _file(std::move(table._file)),
+    _key_data(table._key_data), _value_data(table._value_data),
+    _capacity(table._capacity), _size(table._size), _mask(table._mask),
+    _has_empty_key(table._has_empty_key),
+    _empty_key_value(table._empty_key_value)
+{
+    _bind();
+    table = MerTable();
+}
+
+MerTable& MerTable::operator=(const MerTable& table) {
+    if (this != &table) {
+        _codec = table._codec;
+        _keys = table._keys;
+        _values = table._values;
+        _file = table._file;
+        _key_data = table._key_data;
+        _value_data = table._value_data;
+        _capacity = table._capacity;
+        _size = table._size;
+        _mask = table._mask;
+        _has_empty_key = table._has_empty_key;
+        _empty_key_value = table._empty_key_value;
+        _bind();
+    }
+    return *this;
+}
+
+MerTable& MerTable::operator=(MerTable&& table) {
+    if (this != &table) {
+        std::swap(_codec, table._codec);
+        _keys.swap(table._keys);
+        _values.swap(table._values);
+        _file.swap(table._file);
+        std::swap(_key_data, table._key_data);
+        std::swap(_value_data, table._value_data);
+        std::swap(_capacity, table._capacity);
+        std::swap(_size, table._size);
+        std::swap(_mask, table._mask);
+        std::swap(_has_empty_key, table._has_empty_key);
+        std::swap(_empty_key_value, table._empty_key_value);
+    }
+    return *this;
+}
+
+bool MerTable::insert(const mer_type key, const value_type value) {
+    if (key == empty_key) {
+        if (_has_empty_key)
+            return false;
+        _has_empty_key = true;
+        _empty_key_value = _codec.decode(_codec.encode(value));
+        _size++;
+        return true;
+    }
+    _detach();
+    // keep the load factor at or below 3/4
+    if ((_size + 1) * 4 > capacity() * 3) {
+        _rehash(capacity() == 0 ? _min_capacity : capacity() * 2);
+    }
+    for (size_type i(_hash(key) & _mask); ; i = (i + 1) & _mask) {
+        if (_keys[i] == key)
+            return false;
+        if (_keys[i] == empty_key) {
+            _keys[i] = key;
+            _store(i, _codec.encode(value));
+            _size++;
+            return true;
+        }
+    }
+}
+
+void MerTable::reserveShared(const size_type size) {
+    _detach();
+    reserve(size);
+}
+
+/*
+ * claims an empty slot with a compare-and-swap; the caller has reserved
+ * room for every key, so the table never grows here
+ */
+bool MerTable::insertShared(const mer_type key, const value_type value) {
+    if (key == empty_key) {
+        if (_has_empty_key)
+            return false;
+        _has_empty_key = true;
+        _empty_key_value = _codec.decode(_codec.encode(value));
+        __atomic_fetch_add(&_size, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    for (size_type i(_hash(key) & _mask); ; i = (i + 1) & _mask) {
+        mer_type slot(__atomic_load_n(&_keys[i], __ATOMIC_RELAXED));
+        if (slot == empty_key) {
+            if (__atomic_compare_exchange_n(&_keys[i], &slot, key, false,
+                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                _store(i, _codec.encode(value));
+                __atomic_fetch_add(&_size, 1, __ATOMIC_RELAXED);
+                return true;
+            }
+            // another thread took the slot first, slot now holds its key
+        }
+        if (slot == key)
+            return false;
+    }
+}
+
+void MerTable::reserve(const size_type size) {
+    size_type capacity(_min_capacity);
+    while (capacity * 3 < size * 4) {
+        capacity *= 2;
+    }
+    if (capacity > this->capacity()) {
+        _detach();
+        _rehash(capacity);
+    }
+}
+
+void MerTable::_store(const size_type index, const ScoreCodec::code_type code) {
+    switch (_codec.bytes()) {
+    case 1:
+        _values[index] = code;
+        break;
+    case 2:
+        reinterpret_cast<std::uint16_t*>(&_values[0])[index] = code;
+        break;
+    default:
+        reinterpret_cast<std::uint32_t*>(&_values[0])[index] = code;
+    }
+}
+
+void MerTable::_rehash(const size_type capacity) {
+    const std::size_t bytes(_codec.bytes());
+    std::vector<mer_type> keys(capacity, empty_key);
+    std::vector<unsigned char> values(capacity * bytes, 0);
+    const size_type mask(capacity - 1);
+    for (size_type j(0); j < _keys.size(); j++) {
+        if (_keys[j] == empty_key)
+            continue;
+        size_type i(_hash(_keys[j]) & mask);
+        while (keys[i] != empty_key) {
+            i = (i + 1) & mask;
+        }
+        keys[i] = _keys[j];
+        std::copy(&_values[j * bytes], &_values[j * bytes] + bytes, &values[i * bytes]);
+    }
+    _keys.swap(keys);
+    _values.swap(values);
+    _capacity = capacity;
+    _mask = mask;
+    _bind();
+}
+
+void MerTable::_detach() {
+    if (!isMapped())
+        return;
+    _keys.assign(_key_data, _key_data + _capacity);
+    _values.assign(_value_data, _value_data + _capacity * _codec.bytes());
+    _file.reset();
+    _bind();
+}
+
+void MerTable::_bind() {
+    if (isMapped())
+        return;
+    _key_data = _keys.empty() ? NULL : &_keys[0];
+    _value_data = _values.empty() ? NULL : &_values[0];
+}
+
+double MerTable::loadFactor() const {
+    if (capacity() == 0)
+        return 0.;
+    return double(_size) / capacity();
+}
+
+MerTable::const_iterator MerTable::begin() const {
+    return const_iterator(this, 0);
+}
+
+MerTable::const_iterator MerTable::end() const {
+    return const_iterator(this, capacity() + 1);
+}
+
+} // carl
@@ -0,0 +1,150 @@
+// mer_table.hpp
+
+#ifndef __MER_TABLE_hpp
+#define __MER_TABLE_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <memory>
+#include "mer.hpp"
+#include "mapped_file.hpp"
+#include "score_codec.hpp"
+
+namespace carl {
+
+class MerDatabase;
+
+/*
+ * Open-addressing hash table from packed k-mers to scores.
+ * Keys and values live in two flat arrays of power-of-two capacity and
+ * collisions are resolved by linear probing, so a lookup touches one
+ * key slot in the common case and never follows a pointer.
+ * The all-ones word marks an empty slot; the one k-mer that packs to it
+ * (32 T's) is kept beside the arrays.
+ * Values are stored as ScoreCodec codes of 1, 2 or 4 bytes and decoded
+ * on the way out.
+ * The arrays are either owned or borrowed from a mapped database file;
+ * a borrowed table copies them out before its first modification.
+ * find() never modifies the table and is safe to call from many threads.
+ * insertShared() is too, into a table made ready by reserveShared(), as
+ * long as each key is inserted by one thread only.
+ */
+class MerTable {
+    friend class MerDatabase;
+public:
+    typedef ScoreCodec::value_type value_type;
+    typedef std::size_t size_type;
+
+    class const_iterator {
+    private:
+        const MerTable* _table;
+        size_type _index;
+        void _skip();
+    public:
+        const_iterator(const MerTable* table, size_type index);
+        std::pair<mer_type, value_type> operator*() const;
+        const_iterator& operator++();
+        bool operator!=(const const_iterator& itr) const {
+            return _index != itr._index;
+        }
+    };
+
+    static const mer_type empty_key;
+
+private:
+    static const size_type _min_capacity;
+
+    ScoreCodec _codec;
+    std::vector<mer_type> _keys;
+    std::vector<unsigned char> _values;
+    std::shared_ptr<const MappedFile> _file;
+    const mer_type* _key_data;
+    const unsigned char* _value_data;
+    size_type _capacity;
+    size_type _size;
+    size_type _mask;
+    bool _has_empty_key;
+    value_type _empty_key_value;
+
+    static std::size_t _hash(mer_type key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+    ScoreCodec::code_type _code(const size_type index) const {
+        switch (_codec.bytes()) {
+        case 1:
+            return _value_data[index];
+        case 2:
+            return reinterpret_cast<const std::uint16_t*>(_value_data)[index];
+        default:
+            return reinterpret_cast<const std::uint32_t*>(_value_data)[index];
+        }
+    }
+    void _store(const size_type index, const ScoreCodec::code_type code);
+    void _rehash(const size_type capacity);
+    void _detach();
+    void _bind();
+
+public:
+    explicit MerTable(const ScoreCodec& codec = ScoreCodec());
+    MerTable(const MerTable& table);
+    MerTable(MerTable&& table);
+    MerTable& operator=(const MerTable& table);
+    MerTable& operator=(MerTable&& table);
+    bool insert(const mer_type key, const value_type value);
+    bool find(const mer_type key, value_type& value) const {
+        if (key == empty_key) {
+            if (_has_empty_key)
+                value = _empty_key_value;
+            return _has_empty_key;
+        }
+        if (_capacity == 0)
+            return false;
+        for (size_type i(_hash(key) & _mask); ; i = (i + 1) & _mask) {
+            const mer_type slot(_key_data[i]);
+            if (slot == key) {
+                value = _codec.decode(_code(i));
+                return true;
+            }
+            if (slot == empty_key)
+                return false;
+        }
+    }
+    // pulls the first slot of key towards the cache ahead of find()
+    void prefetch(const mer_type key) const {
+        if (_capacity == 0)
+            return;
+        const size_type i(_hash(key) & _mask);
+        __builtin_prefetch(&_key_data[i]);
+        __builtin_prefetch(&_value_data[i * _codec.bytes()]);
+    }
+    void reserve(const size_type size);
+    // room for size keys and owned arrays, ready for insertShared()
+    void reserveShared(const size_type size);
+    bool insertShared(const mer_type key, const value_type value);
+    size_type size() const {
+        return _size;
+    }
+    size_type capacity() const {
+        return _capacity;
+    }
+    const ScoreCodec& codec() const {
+        return _codec;
+    }
+    bool isMapped() const {
+        return _file.get() != NULL;
+    }
+    double loadFactor() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,127 @@
+// output_writer.cpp
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <limits.h>
+#include <sys/uio.h>
+#include <boost/bind/bind.hpp>
+#include "output_writer.hpp"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace carl {
+
+OutputWriter::OutputWriter(const int fd, const std::size_t max_pending) :
+    _fd(fd), _max_pending(max_pending > 0 ? max_pending : 1), _pending(0),
+    _closed(false), _bytes(0), _calls(0), _seconds(0.),
+    _thread(boost::bind(&OutputWriter::_run, this))
+{
+}
+
+OutputWriter::~OutputWriter() {
+    try {
+        close();
+    } catch (const WriteError&) {
+    }
+}
+
+void OutputWriter::write(std::string& chunk) throw(WriteError) {
+    if (chunk.empty())
+        return;
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    // an oversized chunk goes in alone rather than waiting forever
+    while (_error.empty() && _pending > 0 && _pending + chunk.size() > _max_pending) {
+        _drained.wait(lock);
+    }
+    if (!_error.empty())
+        throw WriteError(_error);
+    _pending += chunk.size();
+    _queue.push_back(std::string());
+    _queue.back().swap(chunk);
+    _queued.notify_one();
+}
+
+void OutputWriter::close() throw(WriteError) {
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _closed = true;
+    }
+    _queued.notify_one();
+    if (_thread.joinable())
+        _thread.join();
+    if (!_error.empty())
+        throw WriteError(_error);
+}
+
+void OutputWriter::_run() {
+    std::deque<std::string> chunks;
+    for (;;) {
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            while (_queue.empty() && !_closed) {
+                _queued.wait(lock);
+            }
+            if (_queue.empty())
+                return;
+            chunks.swap(_queue);
+        }
+        std::size_t size(0);
+        for (std::deque<std::string>::const_iterator itr(chunks.begin());
+                itr != chunks.end(); itr++) {
+            size += itr->size();
+        }
+        _writeAll(chunks);
+        chunks.clear();
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _pending -= size;
+        }
+        _drained.notify_all();
+        if (!_error.empty())
+            return;
+    }
+}
+
+void OutputWriter::_writeAll(std::deque<std::string>& chunks) {
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    std::vector<struct iovec> iov;
+    iov.reserve(std::min<std::size_t>(chunks.size(), IOV_MAX));
+    std::size_t next(0), offset(0);
+    while (next < chunks.size()) {
+        // gathers up to IOV_MAX chunks, the first one from offset on
+        iov.clear();
+        for (std::size_t i(next); i < chunks.size() && iov.size() < IOV_MAX; i++) {
+            struct iovec entry;
+            entry.iov_base = const_cast<char*>(chunks[i].data()) + (i == next ? offset : 0);
+            entry.iov_len = chunks[i].size() - (i == next ? offset : 0);
+            iov.push_back(entry);
+        }
+        const ssize_t written(::writev(_fd, &iov[0], iov.size()));
+        _calls++;
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _error = std::strerror(errno);
+            break;
+        }
+        _bytes += written;
+        // steps past what was written, which may end inside a chunk
+        std::size_t left(written);
+        while (next < chunks.size() && left >= chunks[next].size() - offset) {
+            left -= chunks[next].size() - offset;
+            offset = 0;
+            next++;
+        }
+        offset += left;
+    }
+    _seconds += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+} // carl
@@ -0,0 +1,75 @@
+// output_writer.hpp
+
+#ifndef __OUTPUT_WRITER_hpp
+#define __OUTPUT_WRITER_hpp
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <stdexcept>
+#include <boost/thread.hpp>
+
+namespace carl {
+
+/*
+ * Writes chunks of output to a file descriptor from a thread of its own.
+ * write() queues a chunk and returns at once unless max_pending bytes
+ * are already queued; the thread takes everything queued at once and
+ * hands it to a single writev(2), so a few large system calls carry many
+ * small chunks. Chunks come out in the order they were written.
+ * A failed write is thrown by the next write() or by close().
+ */
+class OutputWriter {
+public:
+    class WriteError : public std::runtime_error {
+    public:
+        WriteError(const std::string& what_arg) :
+            std::runtime_error::runtime_error("WriteError: " + what_arg)
+        {
+        }
+    };
+
+private:
+    const int _fd;
+    const std::size_t _max_pending;
+
+    boost::mutex _mutex;
+    boost::condition_variable _queued, _drained;
+    std::deque<std::string> _queue;
+    std::size_t _pending;
+    bool _closed;
+    std::string _error;
+
+    std::size_t _bytes;
+    std::size_t _calls;
+    double _seconds;
+    boost::thread _thread;
+
+    OutputWriter(const OutputWriter& writer);
+    OutputWriter& operator=(const OutputWriter& writer);
+
+    void _run();
+    void _writeAll(std::deque<std::string>& chunks);
+
+public:
+    OutputWriter(const int fd, const std::size_t max_pending = std::size_t(64) << 20);
+    ~OutputWriter();
+    // takes the contents of chunk, leaving it empty
+    void write(std::string& chunk) throw(WriteError);
+    // writes out what is queued and stops the thread
+    void close() throw(WriteError);
+    // bytes written, writev calls made and seconds spent in them
+    std::size_t bytes() const {
+        return _bytes;
+    }
+    std::size_t calls() const {
+        return _calls;
+    }
+    double seconds() const {
+        return _seconds;
+    }
+};
+
+} // carl
+
+#endif
@@ -0,0 +1,208 @@
+// pipeline.cpp
+
+#include "pipeline.hpp"
+#include <sstream>
+#include <boost/bind/bind.hpp>
+
+namespace carl {
+
+namespace {
+
+void write_stream(std::ostream& os, std::string& chunk) {
+    os.write(chunk.data(), chunk.size());
+    chunk.clear();
+}
+
+void each_record(const Pipeline::function_type& function,
+        const Pipeline::batch_type& batch, std::ostream& os) {
+    for (Pipeline::batch_type::const_iterator itr(batch.begin()); itr != batch.end(); itr++) {
+        function(*itr, os);
+    }
+}
+
+} // anonymous
+
+const std::size_t Pipeline::_flush_size(1 << 20);
+
+Pipeline::Pipeline(const unsigned int num_thread, const std::size_t batch_size) :
+    _num_thread(num_thread), _batch_size(batch_size > 0 ? batch_size : 1),
+    _max_batches(num_thread * 4), _num_read(0), _num_written(0), _closed(false)
+{
+}
+
+void Pipeline::run(FastaReader& reader, const function_type& function,
+        std::ostream& os) {
+    runBatches(reader, boost::bind(&each_record, boost::cref(function),
+                boost::placeholders::_1, boost::placeholders::_2), os);
+}
+
+void Pipeline::run(FastaReader& reader, const function_type& function,
+        OutputWriter& writer) {
+    runBatches(reader, boost::bind(&each_record, boost::cref(function),
+                boost::placeholders::_1, boost::placeholders::_2), writer);
+}
+
+void Pipeline::runBatches(FastaReader& reader, const batch_function_type& function,
+        std::ostream& os) {
+    _run(reader, function, boost::bind(&write_stream, boost::ref(os),
+                boost::placeholders::_1));
+}
+
+void Pipeline::runBatches(FastaReader& reader, const batch_function_type& function,
+        OutputWriter& writer) {
+    _run(reader, function, boost::bind(&OutputWriter::write, &writer,
+                boost::placeholders::_1));
+}
+
+void Pipeline::_run(FastaReader& reader, const batch_function_type& function,
+        const sink_type& sink) {
+    record_type record;
+    if (_num_thread <= 1) {
+        std::ostringstream oss;
+        std::string output;
+        batch_type batch;
+        batch.reserve(_batch_size);
+        bool more(true);
+        while (more) {
+            batch.clear();
+            while (batch.size() < _batch_size && reader.next(record)) {
+                batch.push_back(record);
+            }
+            more = batch.size() == _batch_size;
+            if (!batch.empty())
+                function(batch, oss);
+            if (std::size_t(oss.tellp()) >= _flush_size) {
+                output = oss.str();
+                oss.str("");
+                sink(output);
+            }
+        }
+        output = oss.str();
+        sink(output);
+        return;
+    }
+
+    _queue.clear();
+    _outputs.clear();
+    _num_read = 0;
+    _num_written = 0;
+    _closed = false;
+    _error = std::exception_ptr();
+
+    boost::thread_group threads;
+    for (unsigned int i(0); i < _num_thread; i++) {
+        threads.create_thread(boost::bind(&Pipeline::_work, this,
+                    boost::cref(function)));
+    }
+    boost::thread writer(boost::bind(&Pipeline::_write, this, boost::cref(sink)));
+
+    batch_type batch;
+    bool more(true);
+    while (more) {
+        batch.reserve(_batch_size);
+        while (batch.size() < _batch_size && reader.next(record)) {
+            batch.push_back(record);
+        }
+        more = batch.size() == _batch_size;
+        if (batch.empty())
+            break;
+
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        while (!_error && _num_read - _num_written >= _max_batches) {
+            _written.wait(lock);
+        }
+        if (_error)
+            break;
+        _queue.push_back(std::make_pair(_num_read++, batch_type()));
+        _queue.back().second.swap(batch);
+        _queued.notify_one();
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _closed = true;
+    }
+    _queued.notify_all();
+    _done.notify_all();
+    threads.join_all();
+    writer.join();
+
+    if (_error) {
+        std::rethrow_exception(_error);
+    }
+}
+
+void Pipeline::_work(const batch_function_type& function) {
+    for (;;) {
+        std::pair<std::size_t, batch_type> job;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            while (_queue.empty() && !_closed && !_error) {
+                _queued.wait(lock);
+            }
+            if (_error || _queue.empty())
+                return;
+            job.first = _queue.front().first;
+            job.second.swap(_queue.front().second);
+            _queue.pop_front();
+        }
+
+        std::ostringstream oss;
+        try {
+            function(job.second, oss);
+        } catch(...) {
+            _fail(std::current_exception());
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        _outputs[job.first] = oss.str();
+        if (job.first == _num_written) {
+            _done.notify_one();
+        }
+    }
+}
+
+void Pipeline::_write(const sink_type& sink) {
+    for (;;) {
+        std::string output;
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            std::map<std::size_t, std::string>::iterator itr;
+            while (!_error &&
+                    (itr = _outputs.find(_num_written)) == _outputs.end() &&
+                    !(_closed && _num_written == _num_read)) {
+                _done.wait(lock);
+            }
+            if (_error || itr == _outputs.end())
+                return;
+            output.swap((*itr).second);
+            _outputs.erase(itr);
+        }
+        try {
+            sink(output);
+        } catch(...) {
+            _fail(std::current_exception());
+            return;
+        }
+        {
+            boost::lock_guard<boost::mutex> lock(_mutex);
+            _num_written++;
+        }
+        _written.notify_one();
+    }
+}
+
+void Pipeline::_fail(const std::exception_ptr& error) {
+    {
+        boost::lock_guard<boost::mutex> lock(_mutex);
+        if (!_error) {
+            _error = error;
+        }
+    }
+    _queued.notify_all();
+    _done.notify_all();
+    _written.notify_all();
+}
+
+} // carl
@@ -0,0 +1,75 @@
+// pipeline.hpp
+
+#ifndef __PIPELINE_hpp
+#define __PIPELINE_hpp
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include "fasta_reader.hpp"
+#include "output_writer.hpp"
+
+namespace carl {
+
+/*
+ * Runs a function over every record of a FastaReader on a pool of
+ * worker threads.
+ * The calling thread cuts the input into batches and feeds a bounded
+ * queue, the workers format their output per batch, and a writer
+ * thread emits the batches in input order, so the output is the same
+ * as that of a single thread.
+ * Output goes to an ostream or to an OutputWriter in chunks of at
+ * least a batch, or of _flush_size bytes on a single thread.
+ * runBatches() hands the function a whole batch of records at once
+ * instead of one record at a time.
+ */
+class Pipeline {
+public:
+    typedef FastaReader::Record record_type;
+    typedef std::vector<record_type> batch_type;
+    typedef boost::function<void (const record_type&, std::ostream&)> function_type;
+    typedef boost::function<void (const batch_type&, std::ostream&)> batch_function_type;
+
+private:
+    typedef boost::function<void (std::string&)> sink_type;
+
+    static const std::size_t _flush_size;
+
+    const unsigned int _num_thread;
+    const std::size_t _batch_size;
+    const std::size_t _max_batches;
+
+    boost::mutex _mutex;
+    boost::condition_variable _queued, _done, _written;
+    std::deque<std::pair<std::size_t, batch_type> > _queue;
+    std::map<std::size_t, std::string> _outputs;
+    std::size_t _num_read;
+    std::size_t _num_written;
+    bool _closed;
+    std::exception_ptr _error;
+
+    void _run(FastaReader& reader, const batch_function_type& function,
+            const sink_type& sink);
+    void _work(const batch_function_type& function);
+    void _write(const sink_type& sink);
+    void _fail(const std::exception_ptr& error);
+
+public:
+    Pipeline(const unsigned int num_thread, const std::size_t batch_size = 1024);
+    void run(FastaReader& reader, const function_type& function, std::ostream& os);
+    void run(FastaReader& reader, const function_type& function, OutputWriter& writer);
+    void runBatches(FastaReader& reader, const batch_function_type& function,
+            std::ostream& os);
+    void runBatches(FastaReader& reader, const batch_function_type& function,
+            OutputWriter& writer);
+};
+
+} // carl
+
+#endif
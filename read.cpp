@@ -1,75 +1,163 @@
 #include "read.hpp"
+#include "base_encoder.hpp"
 
 namespace carl {
 
-const char Read::bases[4] = {'a', 'c', 'g', 't'};
+namespace {
 
-Read::Read(const std::string sequence) : _size(sequence.size()) {
-    unsigned char read(0), flg(0);
-    for (size_type i(0); i < size(); i++)
-    {
-        unsigned int bp(4);
-        switch(sequence.at(i)) {
-            case 'a':
-            case 'A':
-                bp = 0;
-                break;
-
-            case 'c':
-            case 'C':
-                bp = 1;
-                break;
-
-            case 'g':
-            case 'G':
-                bp = 2;
-                break;
-
-            case 't':
-            case 'T':
-                bp = 3;
-                break;
-        }
-        read += (bp & 3) << ((i & 3) * 2);
-        if ((i & 3) == 3) {
-            _read.push_back(read);
-            read = 0;
-        }
-        flg += ((bp >> 2) & 1) << (i & 7);
-        if ((i & 7) == 7) {
-            _flgs.push_back(flg);
-            flg = 0;
-        }
+typedef Read::word_type word_type;
+
+// reverses the order of the 2-bit groups of a word
+inline word_type reverse_pairs(word_type x) {
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+// reverses the order of the bits of a word
+inline word_type reverse_bits(word_type x) {
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    return reverse_pairs(x);
+}
+
+inline word_type low_mask(const std::size_t bits) {
+    return bits >= 64 ? ~word_type(0) : (word_type(1) << bits) - 1;
+}
+
+// the 64 bits of words starting at bit offset, joining two words if needed
+inline word_type funnel(const word_type* words, const std::size_t n,
+        const std::size_t offset) {
+    const std::size_t index(offset >> 6), shift(offset & 63);
+    word_type retval(words[index] >> shift);
+    if (shift != 0 && index + 1 < n) {
+        retval |= words[index + 1] << (64 - shift);
     }
-    if ((size() & 3) != 0) {
-        _read.push_back(read);
+    return retval;
+}
+
+// copies bits [offset, offset + bits) of the n words of src into dst
+void extract(const word_type* src, const std::size_t n, const std::size_t offset,
+        const std::size_t bits, word_type* dst) {
+    const std::size_t count((bits + 63) >> 6);
+    for (std::size_t i(0); i < count; i++) {
+        dst[i] = funnel(src, n, offset + (i << 6));
     }
-    if ((size() & 7) != 0) {
-        _flgs.push_back(flg);
+    if ((bits & 63) != 0) {
+        dst[count - 1] &= low_mask(bits & 63);
     }
 }
 
-Read::Read(const Read& read) : _size(read.size()) {
-    _read.resize(read._read.size());
-    _flgs.resize(read._flgs.size());
-    std::copy(read._read.begin(), read._read.end(), _read.begin());
-    std::copy(read._flgs.begin(), read._flgs.end(), _flgs.begin());
+/*
+ * reverses a read of size units of width bits: reverse the word order
+ * and each word with reverse_word, then shift the padding out
+ */
+void reverse_units(const word_type* src, const std::size_t n,
+        const std::size_t size, const std::size_t width,
+        word_type (*reverse_word)(word_type), word_type* dst) {
+    const std::size_t pad((n << 6) - size * width);
+    for (std::size_t i(0); i < n; i++) {
+        word_type word(reverse_word(src[n - i - 1]) >> pad);
+        if (pad != 0 && i + 1 < n) {
+            word |= reverse_word(src[n - i - 2]) << (64 - pad);
+        }
+        dst[i] = word;
+    }
 }
 
-Read::Read(const size_type size) : _size(size) {
-    const std::pair<unsigned int, unsigned int> sizes(_indexes(size));
-    _read.resize(sizes.first+1, 0);
-    _flgs.resize(sizes.second+1, 0);
+} // anonymous
+
+const char Read::bases[4] = {'a', 'c', 'g', 't'};
+
+Read::Read(const std::string sequence) {
+    _allocate(sequence.size());
+    _encode(sequence.data());
 }
 
-Read::Read() : _size(0) {
+Read::Read(const char* sequence, const size_type size) {
+    _allocate(size);
+    _encode(sequence);
 }
 
-std::pair<Read::size_type, Read::size_type> Read::_indexes(size_type index) const {
-    std::pair<size_type, size_type> retval(0,0);
-    retval.first = index >> 2;
-    retval.second = index >> 3;
-    return retval;
+// points _read and _flgs at zeroed storage for size bases
+void Read::_allocate(const size_type size) {
+    _size = size;
+    const std::size_t words(_words());
+    _read = words <= _inline_words ? _inline : new word_type[words];
+    _flgs = _read + _readWords(size);
+    std::fill(_read, _read + words, word_type(0));
+}
+
+void Read::_release() {
+    if (!_isInline())
+        delete[] _read;
+}
+
+// takes over the storage of read, which is left empty
+void Read::_steal(Read& read) {
+    if (read._isInline()) {
+        _allocate(read.size());
+        std::copy(read._read, read._read + read._words(), _read);
+    } else {
+        _size = read._size;
+        _read = read._read;
+        _flgs = read._flgs;
+    }
+    read._allocate(0);
+}
+
+void Read::_encode(const char* sequence) {
+    if (size() == 0)
+        return;
+    // the encoder writes bytes in the order of a little-endian word
+    BaseEncoder::encode(sequence, size(),
+            reinterpret_cast<unsigned char*>(&_read[0]),
+            reinterpret_cast<unsigned char*>(&_flgs[0]));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (std::size_t i(0); i < _words(); i++)
+        _read[i] = __builtin_bswap64(_read[i]);
+#endif
+}
+
+Read::Read(const Read& read) {
+    _allocate(read.size());
+    std::copy(read._read, read._read + read._words(), _read);
+}
+
+Read::Read(Read&& read) {
+    _steal(read);
+}
+
+Read::Read(const size_type size) {
+    _allocate(size);
+}
+
+Read::Read() {
+    _allocate(0);
+}
+
+Read::~Read() {
+    _release();
+}
+
+Read& Read::operator=(const Read& read) {
+    if (this != &read) {
+        if (_words() != read._words()) {
+            _release();
+            _allocate(read.size());
+        }
+        _size = read._size;
+        _flgs = _read + _readWords(_size);
+        std::copy(read._read, read._read + read._words(), _read);
+    }
+    return *this;
+}
+
+Read& Read::operator=(Read&& read) {
+    if (this != &read) {
+        _release();
+        _steal(read);
+    }
+    return *this;
 }
 
 Read::size_type Read::size() const {
@@ -81,16 +169,9 @@ throw(std::out_of_range) {
     if (index >= this->size())
         throw std::out_of_range("out of range in getBaseAt()");
 
-    unsigned char score(0);
-
-    const int f_index(index >> 3);
-    const int f_order(index & 7);
-    score += ((_flgs.at(f_index) >> f_order) & 1) << 2;
-
-    const int r_index(index >> 2);
-    const int r_order((index & 3) << 1);
-    score += (_read.at(r_index) >> r_order) & 3;
-    return score;
+    const unsigned char flg((_flgs[index >> 6] >> (index & 63)) & 1);
+    const unsigned char base((_read[index >> 5] >> ((index & 31) << 1)) & 3);
+    return (flg << 2) | base;
 }
 
 void Read::setBaseAt(const size_type index, const unsigned char value)
@@ -98,25 +179,18 @@ throw(std::out_of_range) {
     if (index >= this->size())
         throw std::out_of_range("out of range in setBaseAt()");
 
-    const int r_index(index >> 2);
-    const int r_order((index & 3) << 1);
-    unsigned char read(_read.at(r_index));
-    read &= 255 - (3 << r_order);
-    read += (value & 3) << r_order;
-    _read[r_index] = read;
+    const unsigned int r_order((index & 31) << 1);
+    word_type& read(_read[index >> 5]);
+    read = (read & ~(word_type(3) << r_order)) | (word_type(value & 3) << r_order);
 
-    const int f_index(index >> 3);
-    const int f_order(index & 7);
-    unsigned char flg(_flgs.at(f_index));
-    flg &= 255 - (1 << f_order);
-    flg += ((value >> 2) & 1) << f_order;
-    _flgs[f_index] = flg;
+    const unsigned int f_order(index & 63);
+    word_type& flg(_flgs[index >> 6]);
+    flg = (flg & ~(word_type(1) << f_order)) | (word_type((value >> 2) & 1) << f_order);
 }
 
 bool Read::isDefinite() const {
-    for (std::vector<unsigned char>::const_iterator itr(_flgs.begin());
-            itr != _flgs.end(); itr++) {
-        if ((unsigned int)(*itr) != 0) {
+    for (std::size_t i(0); i < _flgsWords(size()); i++) {
+        if (_flgs[i] != 0) {
             return false;
         }
     }
@@ -128,10 +202,9 @@ Read Read::sub(const size_type start, const size_type length) const throw(std::o
         throw std::out_of_range("out of range in sub()");
 
     Read retval(length);
-    for (size_type i(0); i < length; i++) {
-        int base(this->getBaseAt(start + i));
-        retval.setBaseAt(i, base);
-    }
+    extract(_read, _readWords(size()), std::size_t(start) << 1,
+            std::size_t(length) << 1, retval._read);
+    extract(_flgs, _flgsWords(size()), start, length, retval._flgs);
     return retval;
 }
 
@@ -139,9 +212,13 @@ Read Read::complement() const {
     if (this->size() == 0)
         return Read();
     Read retval(*this);
-    for (std::vector<unsigned char>::iterator itr(retval._read.begin());
-            itr != retval._read.end(); itr++) {
-        (*itr) = ~(*itr);
+    const std::size_t n(_readWords(size()));
+    for (std::size_t i(0); i < n; i++) {
+        retval._read[i] = ~retval._read[i];
+    }
+    const std::size_t rest((std::size_t(size()) << 1) & 63);
+    if (rest != 0) {
+        retval._read[n - 1] &= low_mask(rest);
     }
     return retval;
 }
@@ -149,11 +226,11 @@ Read Read::complement() const {
 Read Read::reverse() const {
     if (size() == 0)
         return Read();
-    Read retval(*this);
-    for (size_type i(0); i < size(); i++) {
-        unsigned char base(this->getBaseAt(i));
-        retval.setBaseAt(size()-i-1, base);
-    }
+    Read retval(size());
+    reverse_units(_read, _readWords(size()), size(), 2, &reverse_pairs,
+            retval._read);
+    reverse_units(_flgs, _flgsWords(size()), size(), 1, &reverse_bits,
+            retval._flgs);
     return retval;
 }
 
@@ -173,16 +250,22 @@ std::string Read::tostring() const {
 
 } // carl
 
+/*
+ * multiply-xorshift over the packed words, bases and flags, seeded with
+ * the size; the bits past the end are zero, so equal reads hash equal
+ */
 std::size_t hash_value(const carl::Read& read) {
-    std::size_t h(1);
-    for (carl::Read::size_type i(0); i < read.size(); i++) {
-        h = h << 2;
-        int base = read.getBaseAt(i);
-        if ((base & 4) == 1) {
-            return 0;
-        }
-        h += (std::size_t)(base & 3);
+    typedef carl::Read::word_type word_type;
+    const word_type k(0x9e3779b97f4a7c15ULL);
+    word_type h(word_type(read.size()) * k);
+    for (std::size_t i(0); i < read._words(); i++) {
+        h = (h ^ read._read[i]) * k;
+        h ^= h >> 32;
     }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
     return h;
 }
-
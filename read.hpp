@@ -4,29 +4,72 @@
 #ifndef __READ_hpp
 #define __READ_hpp
 
+#include <cstdint>
 #include <string>
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
 
+namespace carl {
+class Read;
+}
+
+std::size_t hash_value(const carl::Read& read);
+
 namespace carl {
 
+class MerIterator;
+template <unsigned int K> class FixedMerIterator;
+
 class Read {
+    friend class MerIterator;
+    template <unsigned int K> friend class FixedMerIterator;
+    friend std::size_t (::hash_value)(const Read& read);
+
 public:
     typedef unsigned int size_type;
+    typedef std::uint64_t word_type;
 private:
     static const char bases[4];
 
-    std::vector<unsigned char> _read;
-    std::vector<unsigned char> _flgs;
+    // reads of up to 64 bases (2 words of bases, 1 word of flags) are
+    // kept in _inline, longer ones in one heap block
+    static const std::size_t _inline_words = 3;
+
+    // 32 bases of 2 bits and 64 flags of 1 bit per word, the first base
+    // in the lowest bits; bits past the end of the read are always zero
+    word_type* _read;
+    word_type* _flgs;
+    word_type _inline[_inline_words];
 
     size_type _size;
 
+    static std::size_t _readWords(const size_type size) {
+        return (std::size_t(size) + 31) >> 5;
+    }
+    static std::size_t _flgsWords(const size_type size) {
+        return (std::size_t(size) + 63) >> 6;
+    }
+    std::size_t _words() const {
+        return _readWords(_size) + _flgsWords(_size);
+    }
+    bool _isInline() const {
+        return _read == _inline;
+    }
+    void _allocate(const size_type size);
+    void _release();
+    void _steal(Read& read);
+
 public:
     Read(const std::string sequence);
+    Read(const char* sequence, const size_type size);
     Read(const Read& read);
+    Read(Read&& read);
     Read(const size_type size);
     Read();
+    ~Read();
+    Read& operator=(const Read& read);
+    Read& operator=(Read&& read);
     size_type size() const;
     unsigned char getBaseAt(const size_type index) const throw(std::out_of_range);
     bool isDefinite() const;
@@ -37,28 +80,28 @@ public:
     std::string tostring() const;
 
     bool operator==(const Read& read) const {
-        if (this->size() != read.size())
-            return false;
-        bool flg(true);
-        for (size_type i(0); i < this->size(); i++) {
-            if (this->getBaseAt(i) != read.getBaseAt(i)) {
-                flg = false;
-                break;
-            }
+        return this->size() == read.size() &&
+            std::equal(this->_read, this->_read + this->_words(), read._read);
+    }
+
+    bool operator<(const Read& read) const {
+        const size_type length(std::min(this->size(), read.size()));
+        for (size_type i(0); i < length; i++) {
+            const unsigned char lhs(this->getBaseAt(i)), rhs(read.getBaseAt(i));
+            if (lhs != rhs)
+                return lhs < rhs;
         }
-        return flg;
+        return this->size() < read.size();
     }
 
 private:
-    std::pair<size_type, size_type> _indexes(size_type index) const;
+    void _encode(const char* sequence);
     void setBaseAt(const size_type index, const unsigned char value)
         throw(std::out_of_range);
 };
 
 } //carl
 
-std::size_t hash_value(const carl::Read& read);
-
 namespace std {
     template <>
     struct hash<carl::Read> {
@@ -0,0 +1,57 @@
+// score_codec.cpp
+
+#include <cmath>
+#include <sstream>
+#include "score_codec.hpp"
+
+namespace carl {
+
+namespace {
+
+const double max_score(4294967295.0);
+
+} // anonymous
+
+ScoreCodec::ScoreCodec(const unsigned int bits, const Mode mode)
+throw(ScoreBitsError) : _bits(bits), _mode(mode), _step(0.) {
+    if (bits != 8 && bits != 16 && bits != 32) {
+        std::ostringstream oss;
+        oss << bits << " is not 8, 16 or 32";
+        throw ScoreBitsError(oss.str());
+    }
+    if (mode == Log && bits == 32) {
+        throw ScoreBitsError("32 bits hold every score, no log scale needed");
+    }
+    _max_code = code_type(max_score) >> (32 - bits);
+    if (mode == Linear) {
+        _threshold = _max_code;
+    } else {
+        // a quarter of the codes for the exact scores, the rest log-spaced
+        _threshold = code_type(1) << (bits - 2);
+        _step = std::log(max_score / _threshold) / (_max_code - _threshold);
+    }
+}
+
+ScoreCodec::code_type ScoreCodec::encode(const value_type score) const {
+    if (score <= _threshold)
+        return score;
+    if (_mode == Linear)
+        return _max_code;
+    const double code(_threshold +
+            std::floor(std::log(double(score) / _threshold) / _step + 0.5));
+    return code >= _max_code ? _max_code : code_type(code);
+}
+
+ScoreCodec::value_type ScoreCodec::_decodeLog(const code_type code) const {
+    const double score(_threshold * std::exp((code - _threshold) * _step));
+    return score >= max_score ? value_type(max_score) : value_type(score + 0.5);
+}
+
+double ScoreCodec::relativeError() const {
+    if (_mode == Linear)
+        return 0.;
+    // half a log step, plus rounding the decoded score to an integer
+    return std::exp(_step / 2) - 1. + 0.5 / _threshold;
+}
+
+} // carl
@@ -0,0 +1,88 @@
+// score_codec.hpp
+
+#ifndef __SCORE_CODEC_hpp
+#define __SCORE_CODEC_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+namespace carl {
+
+/*
+ * How a MerTable stores its scores: in codes of 8, 16 or 32 bits.
+ * Linear codes are the scores themselves; a score that does not fit
+ * saturates at the largest code.
+ * Log codes keep the scores up to threshold() exact and larger ones as
+ * their logarithm, so the whole range of 32 bits fits in 8 or 16. Such
+ * a score comes back within a relative error of relativeError(), 5.6%
+ * for 8 bits and 0.02% for 16, and so does an average of scores.
+ * Either way a score above threshold() may come back as threshold()
+ * itself, so narrow codes only keep scores on the right side of a lower
+ * level below it; keepsLevel() tells which levels those are.
+ */
+class ScoreCodec {
+public:
+    class ScoreBitsError : public std::invalid_argument {
+    public:
+        ScoreBitsError(const std::string& what_arg) :
+            std::invalid_argument::invalid_argument("ScoreBitsError: " + what_arg)
+        {
+        }
+    };
+
+    enum Mode {
+        Linear = 0,
+        Log = 1
+    };
+
+    typedef unsigned int value_type;
+    typedef std::uint32_t code_type;
+
+private:
+    unsigned int _bits;
+    Mode _mode;
+    code_type _max_code;
+    code_type _threshold;
+    double _step;
+
+    value_type _decodeLog(const code_type code) const;
+
+public:
+    ScoreCodec(const unsigned int bits = 32, const Mode mode = Linear)
+        throw(ScoreBitsError);
+    code_type encode(const value_type score) const;
+    value_type decode(const code_type code) const {
+        if (_mode == Linear || code <= _threshold)
+            return code;
+        return _decodeLog(code);
+    }
+    unsigned int bits() const {
+        return _bits;
+    }
+    std::size_t bytes() const {
+        return _bits / 8;
+    }
+    Mode mode() const {
+        return _mode;
+    }
+    value_type threshold() const {
+        return _threshold;
+    }
+    double relativeError() const;
+    // whether every score stays on its side of lower_level once decoded
+    bool keepsLevel(const value_type lower_level) const {
+        return _bits == 32 || lower_level < _threshold;
+    }
+    bool operator==(const ScoreCodec& codec) const {
+        return _bits == codec._bits && _mode == codec._mode;
+    }
+    bool operator!=(const ScoreCodec& codec) const {
+        return !(*this == codec);
+    }
+};
+
+} // carl
+
+#endif
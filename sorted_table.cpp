@@ -0,0 +1,51 @@
+// sorted_table.cpp
+
+#include <algorithm>
+#include "sorted_table.hpp"
+
+namespace carl {
+
+SortedTable::SortedTable() : _length(0), _shift(0) {
+}
+
+SortedTable::SortedTable(entry_list& entries, const Read::size_type length) :
+    _length(length), _shift(0)
+{
+    std::sort(entries.begin(), entries.end());
+    _keys.reserve(entries.size());
+    _values.reserve(entries.size());
+    for (entry_list::const_iterator itr(entries.begin()); itr != entries.end(); itr++) {
+        _keys.push_back(itr->first);
+        _values.push_back(itr->second);
+    }
+
+    // about _bucket_size k-mers per bucket, and at least two buckets
+    unsigned int bits(1);
+    while ((size_type(1) << bits) * _bucket_size < _keys.size() &&
+            bits < _max_index_bits && bits < 2 * length) {
+        bits++;
+    }
+    _shift = 2 * length - bits;
+    _index.assign((size_type(1) << bits) + 1, 0);
+    for (std::vector<mer_type>::const_iterator itr(_keys.begin());
+            itr != _keys.end(); itr++) {
+        _index[(*itr >> _shift) + 1]++;
+    }
+    for (size_type i(1); i < _index.size(); i++) {
+        _index[i] += _index[i - 1];
+    }
+}
+
+bool SortedTable::find(const mer_type key, value_type& value) const {
+    if (_keys.empty())
+        return false;
+    const size_type bucket(key >> _shift);
+    const std::vector<mer_type>::const_iterator end(_keys.begin() + _index[bucket + 1]),
+          itr(std::lower_bound(_keys.begin() + _index[bucket], end, key));
+    if (itr == end || *itr != key)
+        return false;
+    value = _values[itr - _keys.begin()];
+    return true;
+}
+
+} // carl
@@ -0,0 +1,78 @@
+// sorted_table.hpp
+
+#ifndef __SORTED_TABLE_hpp
+#define __SORTED_TABLE_hpp
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "mer.hpp"
+#include "mer_table.hpp"
+
+namespace carl {
+
+/*
+ * Read-only table of packed k-mers kept in ascending order next to their
+ * scores, with a radix index over the top bits of the k-mers: _index[b]
+ * is the first k-mer whose top bits are b, so a lookup only searches the
+ * few k-mers of one bucket.
+ * sweep() resolves a whole sorted batch of k-mers in one forward pass,
+ * which reads the table sequentially instead of probing it at random.
+ */
+class SortedTable {
+public:
+    typedef MerTable::value_type value_type;
+    typedef std::size_t size_type;
+    typedef std::vector<std::pair<mer_type, value_type> > entry_list;
+
+private:
+    // k-mers per bucket the index aims at
+    static const size_type _bucket_size = 8;
+    static const unsigned int _max_index_bits = 28;
+
+    Read::size_type _length;
+    unsigned int _shift;
+    std::vector<mer_type> _keys;
+    std::vector<value_type> _values;
+    std::vector<size_type> _index;
+
+public:
+    SortedTable();
+    // sorts entries, which must not repeat a k-mer, and takes them over
+    SortedTable(entry_list& entries, const Read::size_type length);
+    bool find(const mer_type key, value_type& value) const;
+    /*
+     * calls found(*itr, value) for every itr in [begin, end) whose
+     * itr->first is in the table; itr->first must not decrease
+     */
+    template <class Iterator, class Function>
+    void sweep(Iterator begin, const Iterator end, Function& found) const {
+        if (_keys.empty())
+            return;
+        size_type position(0);
+        for (; begin != end; ++begin) {
+            const mer_type key(begin->first);
+            const size_type bucket(key >> _shift);
+            if (position < _index[bucket])
+                position = _index[bucket];
+            while (position < _index[bucket + 1] && _keys[position] < key) {
+                position++;
+            }
+            if (position < _index[bucket + 1] && _keys[position] == key)
+                found(*begin, _values[position]);
+        }
+    }
+    size_type size() const {
+        return _keys.size();
+    }
+    bool empty() const {
+        return _keys.empty();
+    }
+    Read::size_type merLength() const {
+        return _length;
+    }
+};
+
+} // carl
+
+#endif
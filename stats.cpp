@@ -0,0 +1,123 @@
+// stats.cpp
+
+#include <chrono>
+#include <iomanip>
+#include <sys/resource.h>
+#include "stats.hpp"
+
+namespace carl {
+
+/*
+ * Stats::Timer
+ */
+Stats::Timer::Timer(Stats* stats, const std::string& name) :
+    _stats(stats), _name(name), _wall(0.), _cpu(0.)
+{
+    if (_stats != NULL) {
+        _wall = wallSeconds();
+        _cpu = cpuSeconds();
+    }
+}
+
+Stats::Timer::~Timer() {
+    if (_stats != NULL) {
+        _stats->addPhase(_name, wallSeconds() - _wall, cpuSeconds() - _cpu);
+    }
+}
+
+/*
+ * Stats
+ */
+void Stats::addPhase(const std::string& name, const double wall, const double cpu) {
+    for (std::vector<Phase>::iterator itr(_phases.begin()); itr != _phases.end(); itr++) {
+        if (itr->name == name) {
+            itr->wall += wall;
+            itr->cpu += cpu;
+            return;
+        }
+    }
+    Phase phase;
+    phase.name = name;
+    phase.wall = wall;
+    phase.cpu = cpu;
+    _phases.push_back(phase);
+}
+
+void Stats::setCounter(const std::string& name, const double value) {
+    for (std::vector<std::pair<std::string, double> >::iterator itr(_counters.begin());
+            itr != _counters.end(); itr++) {
+        if (itr->first == name) {
+            itr->second = value;
+            return;
+        }
+    }
+    _counters.push_back(std::make_pair(name, value));
+}
+
+void Stats::report(std::ostream& os) const {
+    const std::ios::fmtflags flags(os.flags());
+    os << std::left << std::setw(24) << "phase"
+       << std::right << std::setw(12) << "wall [s]" << std::setw(12) << "cpu [s]"
+       << std::endl;
+    for (std::vector<Phase>::const_iterator itr(_phases.begin());
+            itr != _phases.end(); itr++) {
+        os << std::left << std::setw(24) << itr->name << std::right
+           << std::fixed << std::setprecision(3)
+           << std::setw(12) << itr->wall << std::setw(12) << itr->cpu << std::endl;
+    }
+    os.flags(flags);
+    for (std::vector<std::pair<std::string, double> >::const_iterator
+            itr(_counters.begin()); itr != _counters.end(); itr++) {
+        os << std::left << std::setw(24) << itr->first << std::right
+           << std::setw(24) << std::setprecision(12) << itr->second << std::endl;
+    }
+    os << std::left << std::setw(24) << "peak_rss_bytes" << std::right
+       << std::setw(24) << peakResidentSize() << std::endl;
+    os.flags(flags);
+}
+
+void Stats::writeJson(std::ostream& os) const {
+    const std::ios::fmtflags flags(os.flags());
+    os << std::setprecision(12);
+    os << "{" << std::endl << "  \"phases\": [";
+    for (std::vector<Phase>::const_iterator itr(_phases.begin());
+            itr != _phases.end(); itr++) {
+        os << (itr == _phases.begin() ? "" : ",") << std::endl
+           << "    {\"name\": \"" << itr->name << "\", \"wall_seconds\": " << itr->wall
+           << ", \"cpu_seconds\": " << itr->cpu << "}";
+    }
+    os << std::endl << "  ]," << std::endl << "  \"counters\": {";
+    for (std::vector<std::pair<std::string, double> >::const_iterator
+            itr(_counters.begin()); itr != _counters.end(); itr++) {
+        os << std::endl << "    \"" << itr->first << "\": " << itr->second << ",";
+    }
+    os << std::endl << "    \"peak_rss_bytes\": " << peakResidentSize()
+       << std::endl << "  }" << std::endl << "}" << std::endl;
+    os.flags(flags);
+}
+
+double Stats::wallSeconds() {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double Stats::cpuSeconds() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+        usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+}
+
+std::size_t Stats::peakResidentSize() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return std::size_t(usage.ru_maxrss) * 1024;
+#endif
+}
+
+} // carl
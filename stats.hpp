@@ -0,0 +1,64 @@
+// stats.hpp
+
+#ifndef __STATS_hpp
+#define __STATS_hpp
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace carl {
+
+/*
+ * Wall and CPU time per phase of a run plus named counters, reported
+ * for humans or as JSON.
+ * CPU time is that of the whole process, so a phase run on many
+ * threads shows more CPU than wall time.
+ * A Stats is filled from one thread; counters gathered on workers are
+ * summed by the caller before they are set.
+ */
+class Stats {
+public:
+    /*
+     * Adds the time from its construction to its destruction to a
+     * phase; does nothing without a Stats.
+     */
+    class Timer {
+    private:
+        Stats* _stats;
+        const std::string _name;
+        double _wall;
+        double _cpu;
+    public:
+        Timer(Stats* stats, const std::string& name);
+        ~Timer();
+    };
+
+private:
+    class Phase {
+    public:
+        std::string name;
+        double wall;
+        double cpu;
+    };
+
+    std::vector<Phase> _phases;
+    std::vector<std::pair<std::string, double> > _counters;
+
+public:
+    void addPhase(const std::string& name, const double wall, const double cpu);
+    void setCounter(const std::string& name, const double value);
+    void report(std::ostream& os) const;
+    void writeJson(std::ostream& os) const;
+
+    static double wallSeconds();
+    static double cpuSeconds();
+    // bytes
+    static std::size_t peakResidentSize();
+};
+
+} // carl
+
+#endif
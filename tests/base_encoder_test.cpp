@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE BaseEncoderTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../base_encoder.hpp"
+#include "../read.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    std::vector<std::string> sequences;
+
+    Fixture() {
+        const char alphabet[] = "acgtACGTnNu-\xc1\x81";
+        std::srand(52);
+        for (std::size_t size(0); size < 200; size++) {
+            std::string sequence;
+            for (std::size_t i(0); i < size; i++) {
+                sequence += alphabet[std::rand() % (sizeof(alphabet) - 1)];
+            }
+            sequences.push_back(sequence);
+        }
+    }
+};
+
+void check_kind(const std::vector<std::string>& sequences, BaseEncoder::Kind kind) {
+    for (std::size_t i(0); i < sequences.size(); i++) {
+        const std::string& sequence(sequences[i]);
+        const std::size_t size(sequence.size());
+        std::vector<unsigned char> bases((size + 3) / 4, 0xff), flags((size + 7) / 8, 0xff);
+        BaseEncoder::encode(kind, sequence.data(), size,
+                bases.empty() ? NULL : &bases[0], flags.empty() ? NULL : &flags[0]);
+        for (std::size_t j(0); j < size; j++) {
+            unsigned char expected(4);
+            switch (sequence[j]) {
+                case 'a': case 'A': expected = 0; break;
+                case 'c': case 'C': expected = 1; break;
+                case 'g': case 'G': expected = 2; break;
+                case 't': case 'T': expected = 3; break;
+            }
+            const unsigned char base((bases[j >> 2] >> ((j & 3) * 2)) & 3);
+            const unsigned char flg((flags[j >> 3] >> (j & 7)) & 1);
+            BOOST_REQUIRE_EQUAL(base | (flg << 2), expected);
+        }
+        if ((size & 3) != 0) {
+            BOOST_CHECK_EQUAL(bases.back() >> ((size & 3) * 2), 0);
+        }
+        if ((size & 7) != 0) {
+            BOOST_CHECK_EQUAL(flags.back() >> (size & 7), 0);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(scalar) {
+    check_kind(sequences, BaseEncoder::Scalar);
+}
+
+BOOST_AUTO_TEST_CASE(sse42) {
+    if (!BaseEncoder::isSupported(BaseEncoder::SSE42))
+        return;
+    check_kind(sequences, BaseEncoder::SSE42);
+}
+
+BOOST_AUTO_TEST_CASE(avx2) {
+    if (!BaseEncoder::isSupported(BaseEncoder::AVX2))
+        return;
+    check_kind(sequences, BaseEncoder::AVX2);
+}
+
+BOOST_AUTO_TEST_CASE(read) {
+    for (std::size_t i(0); i < sequences.size(); i++) {
+        const Read read(sequences[i]);
+        BOOST_REQUIRE_EQUAL(read.size(), sequences[i].size());
+        std::string expected(sequences[i]);
+        for (std::size_t j(0); j < expected.size(); j++) {
+            const char ch(std::tolower(expected[j]));
+            expected[j] = (ch == 'a' || ch == 'c' || ch == 'g' || ch == 't') ? ch : 'n';
+        }
+        BOOST_CHECK_EQUAL(read.tostring(), expected);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+#define BOOST_TEST_MODULE BloomGateTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <set>
+#include "../bloom_gate.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    std::set<mer_type> keys;
+
+    Fixture() {
+        mer_type key(88172645463325252ULL);
+        while (keys.size() < 50000) {
+            key ^= key << 13;
+            key ^= key >> 7;
+            key ^= key << 17;
+            keys.insert(key);
+        }
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    const BloomGate gate;
+    BOOST_CHECK(gate.empty());
+    // an empty gate lets everything through
+    BOOST_CHECK(gate.mayContain(0));
+    BOOST_CHECK(!BloomGate(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(insert) {
+    BloomGate gate(keys.size());
+    BOOST_CHECK_EQUAL(gate.memoryUsage(), (keys.size() * 16 + 511) / 512 * 64);
+    for (std::set<mer_type>::const_iterator itr(keys.begin()); itr != keys.end(); itr++) {
+        gate.insert(*itr);
+    }
+    for (std::set<mer_type>::const_iterator itr(keys.begin()); itr != keys.end(); itr++) {
+        BOOST_REQUIRE(gate.mayContain(*itr));
+    }
+    std::size_t passed(0);
+    for (mer_type key(0); key < 100000; key++) {
+        if (keys.count(key) == 0 && gate.mayContain(key)) {
+            passed++;
+        }
+    }
+    BOOST_CHECK_LT(passed, 500);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#define BOOST_TEST_MODULE DenseTableTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <limits>
+#include <map>
+#include <boost/thread.hpp>
+#include "../dense_table.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    DenseTable table;
+
+    Fixture() : table(8) {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    DenseTable::value_type value;
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    BOOST_CHECK_EQUAL(table.capacity(), 1 << 16);
+    BOOST_CHECK_EQUAL(table.merLength(), 8);
+    BOOST_CHECK(!table.find(0, value));
+    BOOST_CHECK(!(table.begin() != table.end()));
+    const DenseTable empty;
+    BOOST_CHECK_EQUAL(empty.capacity(), 0);
+    BOOST_CHECK(!empty.find(0, value));
+}
+
+BOOST_AUTO_TEST_CASE(insert) {
+    DenseTable::value_type value(0);
+    BOOST_CHECK(table.insert(12345, 52));
+    BOOST_CHECK(!table.insert(12345, 10));
+    BOOST_REQUIRE(table.find(12345, value));
+    BOOST_CHECK_EQUAL(value, 52);
+    BOOST_CHECK(!table.find(54321, value));
+    // the first and last mers are keys like any other
+    BOOST_CHECK(table.insert(0, 3));
+    BOOST_CHECK(table.insert(0xffff, 4));
+    BOOST_REQUIRE(table.find(0xffff, value));
+    BOOST_CHECK_EQUAL(value, 4);
+    // a score of 0 is indistinguishable from an absent mer
+    BOOST_CHECK(!table.insert(777, 0));
+    BOOST_CHECK(!table.find(777, value));
+    BOOST_CHECK_EQUAL(table.size(), 3);
+    BOOST_CHECK_CLOSE(table.loadFactor(), 3. / (1 << 16), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(codec) {
+    const ScoreCodec codecs[] = {ScoreCodec(8), ScoreCodec(16), ScoreCodec(16, ScoreCodec::Log)};
+    for (int i(0); i < 3; i++) {
+        DenseTable small(6, codecs[i]);
+        BOOST_CHECK_EQUAL(DenseTable::memoryFor(6, codecs[i]), 4096 * codecs[i].bytes());
+        for (mer_type key(0); key < 4096; key += 3) {
+            small.insert(key, key * 17);
+        }
+        for (mer_type key(0); key < 4096; key++) {
+            DenseTable::value_type value(0);
+            const bool found(small.find(key, value));
+            BOOST_CHECK_EQUAL(found, key % 3 == 0 && codecs[i].encode(key * 17) != 0);
+            if (found)
+                BOOST_CHECK_EQUAL(value, codecs[i].decode(codecs[i].encode(key * 17)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(iterator) {
+    std::map<mer_type, DenseTable::value_type> expected;
+    for (mer_type key(5); key < 65536; key += 101) {
+        expected[key] = key % 50 + 1;
+        table.insert(key, key % 50 + 1);
+    }
+    std::map<mer_type, DenseTable::value_type> found;
+    for (DenseTable::const_iterator itr(table.begin()); itr != table.end(); ++itr) {
+        BOOST_CHECK(found.insert(*itr).second);
+    }
+    BOOST_CHECK(found == expected);
+}
+
+BOOST_AUTO_TEST_CASE(memoryFor) {
+    BOOST_CHECK_EQUAL(DenseTable::memoryFor(12, ScoreCodec()), std::size_t(64) << 20);
+    BOOST_CHECK_EQUAL(DenseTable::memoryFor(DenseTable::max_length + 1, ScoreCodec(8)),
+            std::numeric_limits<std::size_t>::max());
+}
+
+BOOST_AUTO_TEST_CASE(shared) {
+    // threads inserting disjoint keys build the table insert() does
+    boost::thread_group threads;
+    for (mer_type t(0); t < 4; t++) {
+        threads.create_thread([this, t]() {
+            for (mer_type key(t); key < 65536; key += 4) {
+                table.insertShared(key, key % 9 + 1);
+            }
+        });
+    }
+    threads.join_all();
+    BOOST_CHECK_EQUAL(table.size(), 65536);
+    for (mer_type key(0); key < 65536; key++) {
+        DenseTable::value_type value(0);
+        BOOST_REQUIRE(table.find(key, value));
+        BOOST_CHECK_EQUAL(value, key % 9 + 1);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,133 @@
+#define BOOST_TEST_MODULE FastaReaderTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <fstream>
+#include <cstdio>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+#include <boost/thread.hpp>
+#include "../fasta_reader.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    const std::string filename;
+    FastaReader fasta;
+
+    Fixture() :
+        filename("samples/sample.fasta"),
+        fasta(filename)
+    {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    BOOST_CHECK(!fasta.eof());
+}
+
+BOOST_AUTO_TEST_CASE(next) {
+    FastaReader::Record record;
+    std::ifstream ifs(filename);
+    std::string info, sequence;
+    int count(0);
+    while (getline(ifs, info) && getline(ifs, sequence)) {
+        BOOST_REQUIRE(fasta.next(record));
+        BOOST_CHECK_EQUAL(">" + record.info.str(), info);
+        BOOST_CHECK_EQUAL(record.sequence.str(), sequence);
+        count++;
+    }
+    BOOST_CHECK(count > 0);
+    BOOST_CHECK(fasta.eof());
+    BOOST_CHECK(!fasta.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(no_trailing_newline) {
+    const std::string tmpname("build/tests/fasta_reader_test.fasta");
+    std::ofstream ofs(tmpname);
+    ofs << ">first\nacgt\n>second\nggcc";
+    ofs.close();
+    FastaReader reader(tmpname);
+    FastaReader::Record record;
+    BOOST_REQUIRE(reader.next(record));
+    BOOST_CHECK_EQUAL(record.info.str(), "first");
+    BOOST_CHECK_EQUAL(record.sequence.str(), "acgt");
+    BOOST_REQUIRE(reader.next(record));
+    BOOST_CHECK_EQUAL(record.info.str(), "second");
+    BOOST_CHECK_EQUAL(record.sequence.str(), "ggcc");
+    BOOST_CHECK(!reader.next(record));
+    remove(tmpname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(range) {
+    // adjacent ranges hand out every record exactly once, in order
+    std::vector<std::string> expected;
+    FastaReader::Record record;
+    while (fasta.next(record)) {
+        expected.push_back(record.info.str() + "/" + record.sequence.str());
+    }
+    const std::size_t size(fasta.file().size());
+    const std::size_t shards[] = {1, 2, 3, 7, 64, 5000};
+    for (int n(0); n < 6; n++) {
+        std::vector<std::string> records;
+        for (std::size_t i(0); i < shards[n]; i++) {
+            FastaReader reader(filename, size * i / shards[n], size * (i + 1) / shards[n]);
+            while (reader.next(record)) {
+                records.push_back(record.info.str() + "/" + record.sequence.str());
+            }
+        }
+        BOOST_CHECK(records == expected);
+    }
+    // a range within one record holds nothing, one past the end too
+    BOOST_CHECK(FastaReader(filename, 1, 5).eof());
+    BOOST_CHECK(FastaReader(filename, size, size + 10).eof());
+    FastaReader first(filename, 0, 1);
+    BOOST_CHECK(first.next(record));
+    BOOST_CHECK(!first.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(pipe) {
+    // a pipe cannot be mapped, so it is read to its end instead
+    std::ifstream ifs(filename);
+    std::ostringstream contents;
+    contents << ifs.rdbuf();
+    const std::string text(contents.str());
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(::pipe(fds), 0);
+    boost::thread writer([&text, &fds]() {
+        std::size_t written(0);
+        while (written < text.size()) {
+            const ssize_t count(write(fds[1], text.data() + written, text.size() - written));
+            if (count <= 0)
+                break;
+            written += count;
+        }
+        close(fds[1]);
+    });
+    std::ostringstream path;
+    path << "/dev/fd/" << fds[0];
+    FastaReader reader(path.str());
+    writer.join();
+    BOOST_CHECK(!MappedFile::isRegular(path.str()));
+    close(fds[0]);
+    BOOST_CHECK(!reader.file().mapped());
+    BOOST_CHECK_EQUAL(reader.file().size(), text.size());
+    BOOST_CHECK(MappedFile::isRegular(filename));
+    FastaReader::Record record, expected;
+    while (fasta.next(expected)) {
+        BOOST_REQUIRE(reader.next(record));
+        BOOST_CHECK_EQUAL(record.info.str(), expected.info.str());
+        BOOST_CHECK_EQUAL(record.sequence.str(), expected.sequence.str());
+    }
+    BOOST_CHECK(!reader.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(missing_file) {
+    BOOST_CHECK_THROW(FastaReader("samples/no_such_file.fasta"),
+            MappedFile::OpenError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
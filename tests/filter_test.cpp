@@ -2,6 +2,10 @@
 
 #include <boost/test/included/unit_test.hpp>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <boost/thread.hpp>
 #include "../filter.hpp"
 
 using namespace carl;
@@ -87,6 +91,159 @@ BOOST_AUTO_TEST_CASE(scores) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(canonical) {
+    Filter canonical(10,20,2.,true);
+    BOOST_CHECK(canonical.canonical());
+    Fasta count(countname);
+    BOOST_CHECK(canonical.insertMers(count));
+    Fasta other_count(countname);
+    filter = Filter(10,20,2.);
+    BOOST_CHECK(filter.insertMers(other_count));
+
+    Fasta fasta(filename);
+    for (int i(0); i < 10 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        std::vector<unsigned int> expected(filter.scores(read));
+        std::vector<unsigned int> scores(canonical.scores(read));
+        BOOST_CHECK_EQUAL_COLLECTIONS(scores.begin(), scores.end(),
+                expected.begin(), expected.end());
+        const Read comp(read.reverse().complement());
+        std::vector<unsigned int> comp_scores(canonical.scores(comp));
+        BOOST_CHECK_EQUAL_COLLECTIONS(comp_scores.begin(), comp_scores.end(),
+                expected.rbegin(), expected.rend());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(long_mers) {
+    const Read read("tcaggggggttttaatttactttcgtacacagcgtaaatcttactaaatgtc");
+    const Read::size_type length(40);
+    try {
+        BOOST_CHECK(filter.insertMer(read.sub(0, length), 52));
+        BOOST_CHECK(filter.insertMer(read.sub(3, length).reverse().complement(), 30));
+    } catch(const Filter::MerLengthError& e) {
+        BOOST_FAIL(e.what());
+    }
+    BOOST_CHECK_EQUAL(filter.size(), 2);
+    std::vector<unsigned int> scores(filter.scores(read));
+    BOOST_REQUIRE_EQUAL(scores.size(), read.size() - length + 1);
+    BOOST_CHECK_EQUAL(scores.at(0), 52);
+    BOOST_CHECK_EQUAL(scores.at(1), 1);
+    BOOST_CHECK_EQUAL(scores.at(3), 30);
+}
+
+void score_all(const Filter& filter, const std::vector<Read>& reads,
+        std::vector<std::vector<unsigned int> >& results) {
+    for (int i(0); i < 20; i++) {
+        for (std::size_t j(0); j < reads.size(); j++) {
+            results[j] = filter.scores(reads[j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(shared) {
+    filter = Filter(10,20,2.);
+    Fasta count(countname);
+    BOOST_CHECK(filter.insertMers(count));
+    std::vector<Read> reads;
+    std::vector<std::vector<unsigned int> > expected;
+    Fasta fasta(filename);
+    for (int i(0); i < 50 && !fasta.eof(); i++) {
+        reads.push_back(fasta.getItem().getRead());
+        expected.push_back(filter.scores(reads.back()));
+    }
+
+    const int num_thread(8);
+    std::vector<std::vector<std::vector<unsigned int> > > results(num_thread,
+            std::vector<std::vector<unsigned int> >(reads.size()));
+    boost::thread_group threads;
+    for (int i(0); i < num_thread; i++) {
+        threads.create_thread(boost::bind(&score_all, boost::cref(filter),
+                    boost::cref(reads), boost::ref(results[i])));
+    }
+    threads.join_all();
+    for (int i(0); i < num_thread; i++) {
+        BOOST_CHECK(results[i] == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(move) {
+    Fasta count(countname);
+    BOOST_CHECK(filter.insertMers(count));
+    const int size(filter.size());
+    Filter moved(std::move(filter));
+    BOOST_CHECK_EQUAL(moved.size(), size);
+    Filter assigned;
+    assigned = std::move(moved);
+    BOOST_CHECK_EQUAL(assigned.size(), size);
+    Filter copied;
+    copied = assigned;
+    BOOST_CHECK_EQUAL(copied.size(), size);
+    BOOST_CHECK_EQUAL(assigned.size(), size);
+}
+
+BOOST_AUTO_TEST_CASE(frozen) {
+    Fasta count(countname);
+    BOOST_CHECK(filter.insertMers(count));
+    Filter frozen(filter);
+    frozen.freeze();
+    BOOST_CHECK(frozen.frozen());
+    BOOST_CHECK_EQUAL(frozen.size(), filter.size());
+
+    Fasta fasta(filename);
+    for (int i(0); i < 10 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        std::vector<unsigned int> expected(filter.scores(read));
+        std::vector<unsigned int> scores(frozen.scores(read));
+        BOOST_CHECK_EQUAL_COLLECTIONS(scores.begin(), scores.end(),
+                expected.begin(), expected.end());
+    }
+    BOOST_CHECK_THROW(frozen.insertMer(Read("tcaggggggttttaatttactttcg"), 52),
+            Filter::FrozenError);
+    BOOST_CHECK_THROW(filter.join(frozen), Filter::FrozenError);
+
+    Filter long_filter;
+    long_filter.insertMer(Read("tcaggggggttttaatttactttcgtacacagcgtaaatc"), 52);
+    BOOST_CHECK_THROW(long_filter.freeze(), Filter::MerLengthError);
+}
+
+BOOST_AUTO_TEST_CASE(gated) {
+    Fasta count(countname);
+    BOOST_CHECK(filter.insertMers(count));
+    Filter gated(filter);
+    gated.buildGate();
+    BOOST_CHECK(gated.gated());
+    BOOST_CHECK(gated.insertMer(Read("acgtacgtacgtacgtacgtacgta"), 52));
+    BOOST_CHECK(filter.insertMer(Read("acgtacgtacgtacgtacgtacgta"), 52));
+
+    Fasta fasta(filename);
+    for (int i(0); i < 10 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        std::vector<unsigned int> expected(filter.scores(read));
+        std::vector<unsigned int> scores(gated.scores(read));
+        BOOST_CHECK_EQUAL_COLLECTIONS(scores.begin(), scores.end(),
+                expected.begin(), expected.end());
+    }
+    const std::vector<unsigned int> scores(gated.scores(Read("acgtacgtacgtacgtacgtacgta")));
+    BOOST_REQUIRE_EQUAL(scores.size(), 1);
+    BOOST_CHECK_EQUAL(scores[0], 52);
+
+    gated.freeze();
+    BOOST_CHECK(gated.gated());
+    BOOST_CHECK_THROW(gated.buildGate(), Filter::FrozenError);
+}
+
+BOOST_AUTO_TEST_CASE(long_gated) {
+    // long mers go without a gate rather than failing
+    const Read read("tcaggggggttttaatttactttcgtacacagcgtaaatcttactaaatgtc");
+    Filter long_filter(10, 20, 2.);
+    long_filter.insertMer(read.sub(0, 40), 52);
+    const std::vector<unsigned int> expected(long_filter.scores(read));
+    BOOST_CHECK_NO_THROW(long_filter.buildGate());
+    BOOST_CHECK(!long_filter.gated());
+    BOOST_CHECK(long_filter.scores(read) == expected);
+    BOOST_CHECK_EQUAL(expected[0], 52);
+}
+
 BOOST_AUTO_TEST_CASE(check) {
     filter = Filter(10,20,2.);
     std::vector<unsigned int> scores;
@@ -117,6 +274,244 @@ BOOST_AUTO_TEST_CASE(check) {
     BOOST_CHECK(!filter.check(scores));
 }
 
+BOOST_AUTO_TEST_CASE(saturated) {
+    // mers of 200 and 1000 alternate; an 8-bit 1000 saturates at 255,
+    // which at a level of 255 or more turns it into a lower mer
+    const Read read("tcaggggggttttaatttactttcgtacacagcgtaaatcttactaaatgtc");
+    const unsigned int levels[] = {254, 255, 300};
+    for (int l(0); l < 3; l++) {
+        Filter wide(levels[l], 0, 1.), narrow(levels[l], 0, 1., false, ScoreCodec(8));
+        for (Read::size_type i(0); i + 20 <= read.size(); i++) {
+            wide.insertMer(read.sub(i, 20), i % 2 == 0 ? 200 : 1000);
+            narrow.insertMer(read.sub(i, 20), i % 2 == 0 ? 200 : 1000);
+        }
+        BOOST_CHECK(!wide.check(read));
+        // only levels below the largest code keep the verdict
+        BOOST_CHECK_EQUAL(narrow.codec().keepsLevel(levels[l]), levels[l] < 255);
+        BOOST_CHECK_EQUAL(narrow.check(read) == wide.check(read), levels[l] < 255);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(fused) {
+    // the streaming check and average agree with the ones over scores,
+    // including the early rejection taken with small ratios
+    const unsigned int levels[] = {10, 12, 30};
+    const unsigned int intervals[] = {0, 1, 5, 20};
+    const double ratios[] = {0.5, 1., 2.};
+    for (int l(0); l < 3; l++) {
+        for (int m(0); m < 4; m++) {
+            for (int r(0); r < 3; r++) {
+                Filter fused(levels[l], intervals[m], ratios[r]);
+                Fasta count(countname);
+                fused.insertMers(count);
+                Fasta fasta(filename);
+                for (int i(0); i < 30 && !fasta.eof(); i++) {
+                    const Read read(fasta.getItem().getRead());
+                    const std::vector<unsigned int> scores(fused.scores(read));
+                    BOOST_CHECK_EQUAL(fused.check(read), fused.check(scores));
+                    BOOST_CHECK_EQUAL(fused.average(read), fused.average(scores));
+                }
+            }
+        }
+    }
+    BOOST_CHECK(!filter.check(Read("acgt")));
+    BOOST_CHECK_EQUAL(filter.average(Read("acgt")), 0);
+}
+
+BOOST_AUTO_TEST_CASE(insertCounts) {
+    // counted mers score like the same counts inserted one by one
+    MerCounter counter(25), wrong_length(21);
+    Filter canonical(10, 20, 2., true), imported(10, 20, 2., true), both(10, 20, 2.);
+    Fasta fasta(filename);
+    std::vector<Read> reads;
+    while (!fasta.eof()) {
+        reads.push_back(fasta.getItem().getRead());
+        counter.count(reads.back());
+    }
+    std::vector<std::pair<mer_type, MerCounter::count_type> > counts;
+    counter.drain([&](const mer_type mer, const MerCounter::count_type count) {
+        counts.push_back(std::make_pair(mer, count));
+        imported.insertMer(MerIterator::toRead(mer, 25), count);
+    });
+    for (std::size_t i(0); i < reads.size(); i++) {
+        counter.count(reads[i]);
+    }
+    MerCounter copy(25);
+    for (std::size_t i(0); i < reads.size(); i++) {
+        copy.count(reads[i]);
+    }
+    BOOST_CHECK(canonical.insertCounts(counter));
+    BOOST_CHECK(both.insertCounts(copy));
+    BOOST_CHECK_EQUAL(canonical.size(), imported.size());
+    BOOST_CHECK_EQUAL(both.size(), canonical.size());
+    BOOST_CHECK(std::size_t(canonical.size()) < counts.size());
+    for (std::size_t i(0); i < 200; i++) {
+        BOOST_CHECK(canonical.scores(reads[i]) == imported.scores(reads[i]));
+        BOOST_CHECK(both.scores(reads[i]) == imported.scores(reads[i]));
+    }
+    BOOST_CHECK_THROW(canonical.insertCounts(wrong_length), Filter::MerLengthError);
+    canonical.freeze();
+    BOOST_CHECK_THROW(canonical.insertCounts(copy), Filter::FrozenError);
+}
+
+BOOST_AUTO_TEST_CASE(importMers) {
+    // any number of threads imports what insertMers does
+    std::vector<Read> reads;
+    Fasta fasta(filename);
+    for (int i(0); i < 100 && !fasta.eof(); i++) {
+        reads.push_back(fasta.getItem().getRead());
+    }
+    const std::string longname("build/tests/filter_test_long.count");
+    std::ofstream ofs(longname);
+    ofs << ">bad\n" << reads[0].sub(0, 40).tostring() << "\n";
+    for (std::size_t i(0); i < reads.size(); i++) {
+        ofs << ">" << i % 7 << "\n" << reads[i].sub(0, 40).tostring() << "\n";
+        ofs << ">5\n" << reads[i].sub(3, 30).tostring() << "\n";
+    }
+    ofs.close();
+
+    for (int c(0); c < 2; c++) {
+        Filter expected(10, 20, 2., c == 1), long_expected(10, 20, 2., c == 1);
+        Fasta count(countname), long_count(longname);
+        expected.insertMers(count);
+        long_expected.insertMers(long_count);
+        for (unsigned int num_thread(1); num_thread <= 8; num_thread *= 2) {
+            Filter imported(10, 20, 2., c == 1), long_imported(10, 20, 2., c == 1);
+            BOOST_CHECK(imported.importMers(countname, num_thread));
+            BOOST_CHECK(long_imported.importMers(longname, num_thread));
+            BOOST_CHECK_EQUAL(imported.size(), expected.size());
+            BOOST_CHECK_EQUAL(long_imported.size(), long_expected.size());
+            for (std::size_t i(0); i < reads.size(); i++) {
+                BOOST_CHECK(imported.scores(reads[i]) == expected.scores(reads[i]));
+                BOOST_CHECK(long_imported.scores(reads[i]) ==
+                        long_expected.scores(reads[i]));
+            }
+        }
+    }
+    Filter frozen(10, 20, 2.);
+    frozen.importMers(countname, 2);
+    frozen.freeze();
+    BOOST_CHECK_THROW(frozen.importMers(countname, 2), Filter::FrozenError);
+    remove(longname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(dense) {
+    // a dense filter scores like a hashed one, however it was filled
+    std::vector<Read> reads;
+    Fasta fasta(filename);
+    for (int i(0); i < 100 && !fasta.eof(); i++) {
+        reads.push_back(fasta.getItem().getRead());
+    }
+    const std::string shortname("build/tests/filter_test_short.count"),
+          dbname("build/tests/filter_test_short.db");
+    std::ofstream ofs(shortname);
+    for (std::size_t i(0); i < reads.size(); i++) {
+        ofs << ">" << i % 9 << "\n" << reads[i].sub(i % 20, 12).tostring() << "\n";
+    }
+    ofs.close();
+
+    for (int c(0); c < 2; c++) {
+        Filter hashed(10, 20, 2., c == 1, ScoreCodec(), 0), dense(10, 20, 2., c == 1),
+               shared(10, 20, 2., c == 1), joined(10, 20, 2., c == 1);
+        Fasta count(shortname), dense_count(shortname);
+        hashed.insertMers(count);
+        dense.insertMers(dense_count);
+        shared.importMers(shortname, 3);
+        joined.join(dense);
+        BOOST_CHECK(!hashed.dense());
+        BOOST_CHECK(dense.dense() && shared.dense() && joined.dense());
+        BOOST_CHECK(hashed.size() > 0);
+        BOOST_CHECK_EQUAL(dense.size(), hashed.size());
+        BOOST_CHECK_EQUAL(shared.size(), hashed.size());
+        BOOST_CHECK_EQUAL(joined.size(), hashed.size());
+        dense.writeDatabase(dbname);
+        Filter loaded(10, 20, 2., c == 1), loaded_hashed(10, 20, 2., c == 1, ScoreCodec(), 0);
+        loaded.loadDatabase(dbname);
+        loaded_hashed.loadDatabase(dbname);
+        BOOST_CHECK(loaded.dense());
+        BOOST_CHECK(!loaded_hashed.dense());
+        BOOST_CHECK_EQUAL(loaded.size(), hashed.size());
+        BOOST_CHECK_EQUAL(loaded_hashed.size(), hashed.size());
+        dense.buildGate();
+        BOOST_CHECK(!dense.gated());
+        for (std::size_t i(0); i < reads.size(); i++) {
+            const std::vector<unsigned int> scores(hashed.scores(reads[i]));
+            BOOST_CHECK(dense.scores(reads[i]) == scores);
+            BOOST_CHECK(shared.scores(reads[i]) == scores);
+            BOOST_CHECK(joined.scores(reads[i]) == scores);
+            BOOST_CHECK(loaded.scores(reads[i]) == scores);
+            BOOST_CHECK(loaded_hashed.scores(reads[i]) == scores);
+        }
+        dense.freeze();
+        BOOST_CHECK(dense.frozen());
+        BOOST_CHECK(dense.scores(reads[0]) == hashed.scores(reads[0]));
+    }
+    remove(shortname.c_str());
+    remove(dbname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(sorted) {
+    // a sorted filter scores a batch of reads like a hashed one scores each
+    std::vector<Read> reads;
+    Fasta fasta(filename);
+    for (int i(0); i < 200 && !fasta.eof(); i++) {
+        reads.push_back(fasta.getItem().getRead());
+    }
+    reads.push_back(Read("acgt"));
+    reads.push_back(Read("acgtnacgtacgtannacgtaggcattacgatcgatcgggatcgatcgatttagc"));
+    for (int c(0); c < 2; c++) {
+        Filter hashed(10, 20, 2., c == 1), sorted(10, 20, 2., c == 1);
+        Fasta count(countname), sorted_count(countname);
+        hashed.insertMers(count);
+        sorted.insertMers(sorted_count);
+        sorted.sortTable();
+        BOOST_CHECK(sorted.sorted() && sorted.frozen());
+        BOOST_CHECK_EQUAL(sorted.size(), hashed.size());
+        const std::vector<std::vector<unsigned int> > scores(sorted.scores(reads)),
+              hashed_scores(hashed.scores(reads));
+        BOOST_REQUIRE_EQUAL(scores.size(), reads.size());
+        for (std::size_t i(0); i < reads.size(); i++) {
+            BOOST_CHECK(scores[i] == hashed.scores(reads[i]));
+            BOOST_CHECK(hashed_scores[i] == scores[i]);
+            BOOST_CHECK(sorted.scores(reads[i]) == scores[i]);
+        }
+        BOOST_CHECK_THROW(sorted.insertMer(reads[0].sub(0, 25), 5), Filter::FrozenError);
+        BOOST_CHECK_THROW(sorted.sortTable(), Filter::FrozenError);
+    }
+    {
+        Filter frozen(10, 20, 2.);
+        Fasta count(countname);
+        frozen.insertMers(count);
+        frozen.freeze();
+        BOOST_CHECK_THROW(frozen.sortTable(), Filter::FrozenError);
+    }
+    BOOST_CHECK_THROW(filter.sortTable(), Filter::MerLengthError);
+}
+
+BOOST_AUTO_TEST_CASE(tally) {
+    filter = Filter(10, 20, 2.);
+    Fasta count(countname);
+    filter.insertMers(count);
+    Fasta fasta(filename);
+    Filter::Tally tally, checked;
+    std::size_t mers(0), hits(0);
+    for (int i(0); i < 30 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        const std::vector<unsigned int> scores(filter.scores(read));
+        mers += scores.size();
+        hits += scores.size() - std::count(scores.begin(), scores.end(),
+                filter.defaultScore());
+        BOOST_CHECK_EQUAL(filter.average(read, &tally), filter.average(scores));
+        BOOST_CHECK_EQUAL(filter.check(read, &checked), filter.check(scores));
+    }
+    BOOST_CHECK_EQUAL(tally.mers, mers);
+    BOOST_CHECK_EQUAL(tally.hits, hits);
+    BOOST_CHECK(hits > 0 && hits < mers);
+    // check may stop early, so it sees at most as many mers
+    BOOST_CHECK(checked.mers <= mers);
+    BOOST_CHECK(checked.hits <= checked.mers);
+}
+
 BOOST_AUTO_TEST_CASE(average) {
     filter = Filter(1,20,2.);
     std::vector<unsigned int> scores;
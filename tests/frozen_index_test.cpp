@@ -0,0 +1,70 @@
+#define BOOST_TEST_MODULE FrozenIndexTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdlib>
+#include <map>
+#include "../frozen_index.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    MerTable table;
+    std::map<mer_type, MerTable::value_type> expected;
+
+    Fixture() : table() {
+        std::srand(12);
+        for (int i(0); i < 20000; i++) {
+            const mer_type key((mer_type(std::rand()) << 31) ^ std::rand());
+            const MerTable::value_type value(std::rand() % 5000);
+            if (table.insert(key, value)) {
+                expected[key] = value;
+            }
+        }
+        // the all-ones k-mer is kept beside the table arrays
+        table.insert(~mer_type(0), 4999);
+        expected[~mer_type(0)] = 4999;
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    const FrozenIndex index;
+    FrozenIndex::value_type value;
+    BOOST_CHECK_EQUAL(index.size(), 0);
+    BOOST_CHECK(!index.find(0, value));
+}
+
+BOOST_AUTO_TEST_CASE(find) {
+    const FrozenIndex index(table);
+    BOOST_CHECK_EQUAL(index.size(), expected.size());
+    BOOST_CHECK_EQUAL(index.scoreWidth(), 13);
+    for (std::map<mer_type, MerTable::value_type>::const_iterator itr(expected.begin());
+            itr != expected.end(); itr++) {
+        FrozenIndex::value_type value(0);
+        BOOST_REQUIRE(index.find(itr->first, value));
+        BOOST_CHECK_EQUAL(value, itr->second);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(absent) {
+    const FrozenIndex index(table);
+    std::size_t false_positives(0);
+    for (mer_type key(1); key <= 100000; key++) {
+        FrozenIndex::value_type value;
+        if (expected.count(key) == 0 && index.find(key, value)) {
+            false_positives++;
+        }
+    }
+    // about 100000 / 2^16 expected
+    BOOST_CHECK_LT(false_positives, 10);
+}
+
+BOOST_AUTO_TEST_CASE(memory) {
+    const FrozenIndex index(table);
+    // fingerprint and score bits plus a few bits of hash per mer
+    BOOST_CHECK_LT(index.memoryUsage(), expected.size() * 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+#define BOOST_TEST_MODULE MerCounterTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <map>
+#include <sstream>
+#include <unistd.h>
+#include <boost/bind/bind.hpp>
+#include "../mer_counter.hpp"
+#include "../fasta_reader.hpp"
+
+using namespace carl;
+using namespace boost::placeholders;
+
+typedef std::map<mer_type, MerCounter::count_type> count_map;
+
+void collect(count_map* counts, const mer_type mer, const MerCounter::count_type count) {
+    BOOST_CHECK(counts->insert(std::make_pair(mer, count)).second);
+}
+
+struct Fixture {
+    const std::string filename;
+    std::string prefix;
+    count_map expected;
+    std::size_t reads;
+    std::size_t mers;
+
+    Fixture() : filename("samples/sample.fasta"), reads(0), mers(0) {
+        std::ostringstream oss;
+        oss << "/tmp/mer_counter_test_" << getpid();
+        prefix = oss.str();
+
+        FastaReader reader(filename);
+        FastaReader::Record record;
+        while (reader.next(record)) {
+            const Read read(record.sequence.data, record.sequence.size);
+            MerIterator itr(read, 25);
+            while (itr.next()) {
+                expected[itr.canonical()]++;
+                mers++;
+            }
+            reads++;
+        }
+    }
+
+    count_map count(MerCounter& counter) {
+        count_map retval;
+        const std::size_t size(counter.drain(boost::bind(&collect, &retval, _1, _2)));
+        BOOST_CHECK_EQUAL(size, retval.size());
+        return retval;
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    BOOST_CHECK_THROW(MerCounter(0), MerCounter::MerLengthError);
+    BOOST_CHECK_THROW(MerCounter(33), MerCounter::MerLengthError);
+    const MerCounter counter(32);
+    BOOST_CHECK_EQUAL(counter.merLength(), 32);
+    BOOST_CHECK_EQUAL(counter.reads(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(read) {
+    MerCounter counter(3);
+    // acg and cgt are each other's reverse complement
+    counter.count(Read("acgtnacgt"));
+    count_map counts(count(counter));
+    BOOST_CHECK_EQUAL(counts.size(), 1);
+    BOOST_CHECK_EQUAL(counts[MerIterator::pack(Read("acg"))], 4);
+    BOOST_CHECK_EQUAL(counter.mers(), 4);
+    BOOST_CHECK(count(counter).empty());
+}
+
+BOOST_AUTO_TEST_CASE(threads) {
+    const unsigned int threads[] = {1, 4};
+    for (int i(0); i < 2; i++) {
+        MerCounter counter(25, threads[i]);
+        FastaReader reader(filename);
+        counter.count(reader);
+        BOOST_CHECK_EQUAL(counter.reads(), reads);
+        BOOST_CHECK_EQUAL(counter.mers(), mers);
+        BOOST_CHECK_EQUAL(counter.spills(), 0);
+        BOOST_CHECK(count(counter) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(spill) {
+    // 64 KiB holds a small fraction of the distinct mers
+    MerCounter counter(25, 3, 1 << 16, prefix);
+    FastaReader reader(filename);
+    counter.count(reader);
+    BOOST_CHECK(counter.spills() > 0);
+    BOOST_CHECK(access((prefix + "_0").c_str(), F_OK) == 0);
+    BOOST_CHECK(count(counter) == expected);
+    BOOST_CHECK(access((prefix + "_0").c_str(), F_OK) != 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
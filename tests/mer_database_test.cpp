@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE MerDatabaseTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include "../mer_database.hpp"
+#include "../filter.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    const std::string filename, countname, dbname;
+    Filter filter;
+
+    Fixture() :
+        filename("samples/sample.fasta"),
+        countname("samples/sample.count"),
+        dbname("build/tests/mer_database_test.db"),
+        filter(10,20,2.,true)
+    {
+        Fasta count(countname);
+        filter.insertMers(count);
+        filter.writeDatabase(dbname);
+    }
+
+    ~Fixture() {
+        remove(dbname.c_str());
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(isDatabase) {
+    BOOST_CHECK(MerDatabase::isDatabase(dbname));
+    BOOST_CHECK(!MerDatabase::isDatabase(countname));
+    BOOST_CHECK(!MerDatabase::isDatabase("samples/no_such_file"));
+}
+
+BOOST_AUTO_TEST_CASE(header) {
+    const MerDatabase database(dbname, true);
+    BOOST_CHECK_EQUAL(database.merLength(), 25);
+    BOOST_CHECK_EQUAL(database.lowerLevel(), 10);
+    BOOST_CHECK(database.canonical());
+    BOOST_CHECK_EQUAL(database.table().size(), filter.size());
+    BOOST_CHECK(database.table().isMapped());
+}
+
+BOOST_AUTO_TEST_CASE(loadDatabase) {
+    Filter loaded(3,20,2.);
+    loaded.loadDatabase(dbname, true);
+    BOOST_CHECK(loaded.canonical());
+    BOOST_CHECK_EQUAL(loaded.lowerLevel(), 10);
+    BOOST_CHECK_EQUAL(loaded.size(), filter.size());
+    Fasta fasta(filename);
+    for (int i(0); i < 20 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        std::vector<unsigned int> expected(filter.scores(read));
+        std::vector<unsigned int> scores(loaded.scores(read));
+        BOOST_CHECK_EQUAL_COLLECTIONS(scores.begin(), scores.end(),
+                expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(modify_loaded) {
+    Filter loaded;
+    loaded.loadDatabase(dbname);
+    const int size(loaded.size());
+    BOOST_CHECK(loaded.insertMer(Read("acgtacgtacgtacgtacgtacgta"), 52));
+    BOOST_CHECK_EQUAL(loaded.size(), size + 1);
+    const MerDatabase database(dbname, true);
+    BOOST_CHECK_EQUAL(database.table().size(), size);
+}
+
+BOOST_AUTO_TEST_CASE(narrow) {
+    const std::string narrowname(dbname + ".narrow");
+    Filter narrow(10,20,2.,true,ScoreCodec(8, ScoreCodec::Log));
+    Fasta count(countname);
+    narrow.insertMers(count);
+    narrow.writeDatabase(narrowname);
+
+    const MerDatabase database(narrowname, true);
+    BOOST_CHECK_EQUAL(database.table().codec().bits(), 8);
+    BOOST_CHECK(database.table().codec().mode() == ScoreCodec::Log);
+    std::ifstream ifs(narrowname.c_str(), std::ios::binary | std::ios::ate);
+    BOOST_CHECK_EQUAL(std::size_t(ifs.tellg()), sizeof(MerDatabase::Header) +
+            database.table().capacity() * (sizeof(mer_type) + 1));
+
+    Filter loaded;
+    loaded.loadDatabase(narrowname, true);
+    Fasta fasta(filename);
+    for (int i(0); i < 20 && !fasta.eof(); i++) {
+        const Read read(fasta.getItem().getRead());
+        std::vector<unsigned int> expected(narrow.scores(read));
+        std::vector<unsigned int> scores(loaded.scores(read));
+        BOOST_CHECK_EQUAL_COLLECTIONS(scores.begin(), scores.end(),
+                expected.begin(), expected.end());
+    }
+    remove(narrowname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(corruption) {
+    {
+        std::fstream fs(dbname.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(-1, std::ios::end);
+        fs.put('\x7f');
+    }
+    BOOST_CHECK_NO_THROW(MerDatabase(dbname, false));
+    BOOST_CHECK_THROW(MerDatabase(dbname, true), MerDatabase::FormatError);
+    {
+        std::fstream fs(dbname.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        fs.seekp(12);
+        fs.put('\x7f');
+    }
+    BOOST_CHECK_THROW(MerDatabase(dbname, false), MerDatabase::FormatError);
+    BOOST_CHECK_THROW(MerDatabase(countname, false), MerDatabase::FormatError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
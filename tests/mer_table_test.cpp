@@ -0,0 +1,151 @@
+#define BOOST_TEST_MODULE MerTableTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <map>
+#include <boost/thread.hpp>
+#include "../mer_table.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    MerTable table;
+
+    Fixture() : table() {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    MerTable::value_type value;
+    BOOST_CHECK_EQUAL(table.size(), 0);
+    BOOST_CHECK(!table.find(0, value));
+    BOOST_CHECK(!(table.begin() != table.end()));
+}
+
+BOOST_AUTO_TEST_CASE(insert) {
+    MerTable::value_type value(0);
+    BOOST_CHECK(table.insert(12345, 52));
+    BOOST_CHECK(!table.insert(12345, 10));
+    BOOST_REQUIRE(table.find(12345, value));
+    BOOST_CHECK_EQUAL(value, 52);
+    BOOST_CHECK(!table.find(54321, value));
+    BOOST_CHECK_EQUAL(table.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(empty_key) {
+    const mer_type all_t(~mer_type(0));
+    MerTable::value_type value(0);
+    BOOST_CHECK(!table.find(all_t, value));
+    BOOST_CHECK(table.insert(all_t, 7));
+    BOOST_CHECK(!table.insert(all_t, 8));
+    BOOST_REQUIRE(table.find(all_t, value));
+    BOOST_CHECK_EQUAL(value, 7);
+    BOOST_CHECK_EQUAL(table.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(rehash) {
+    std::map<mer_type, MerTable::value_type> expected;
+    mer_type key(88172645463325252ULL);
+    for (unsigned int i(0); i < 100000; i++) {
+        key ^= key << 13;
+        key ^= key >> 7;
+        key ^= key << 17;
+        const bool inserted(expected.insert(std::make_pair(key, i)).second);
+        BOOST_CHECK_EQUAL(table.insert(key, i), inserted);
+    }
+    BOOST_CHECK_EQUAL(table.size(), expected.size());
+    BOOST_CHECK(table.loadFactor() <= 0.75);
+    for (std::map<mer_type, MerTable::value_type>::const_iterator itr(expected.begin());
+            itr != expected.end(); itr++) {
+        MerTable::value_type value(0);
+        BOOST_REQUIRE(table.find((*itr).first, value));
+        BOOST_CHECK_EQUAL(value, (*itr).second);
+    }
+    MerTable::value_type value;
+    BOOST_CHECK(!table.find(0, value));
+}
+
+BOOST_AUTO_TEST_CASE(iterator) {
+    table.reserve(1000);
+    const MerTable::size_type capacity(table.capacity());
+    for (mer_type key(0); key < 1000; key++) {
+        table.insert(key * 7, key);
+    }
+    table.insert(~mer_type(0), 1000);
+    BOOST_CHECK_EQUAL(table.capacity(), capacity);
+    MerTable::size_type count(0);
+    for (MerTable::const_iterator itr(table.begin()); itr != table.end(); ++itr) {
+        const std::pair<mer_type, MerTable::value_type> entry(*itr);
+        if (entry.first == ~mer_type(0)) {
+            BOOST_CHECK_EQUAL(entry.second, 1000);
+        } else {
+            BOOST_CHECK_EQUAL(entry.first, entry.second * 7);
+        }
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, table.size());
+}
+
+BOOST_AUTO_TEST_CASE(shared) {
+    // four threads insert the keys i with i % 4 == t, and retry some
+    const std::size_t size(100000);
+    table.insert(7, 1);
+    table.reserveShared(size + 1);
+    const std::size_t capacity(table.capacity());
+    boost::thread_group threads;
+    std::vector<std::size_t> inserted(4, 0);
+    for (std::size_t t(0); t < 4; t++) {
+        threads.create_thread([&, t]() {
+            for (std::size_t i(t); i < size; i += 4) {
+                inserted[t] += table.insertShared(i, i % 1000 + 2);
+                inserted[t] += table.insertShared(i, 1) ? 1 : 0;
+            }
+            if (t == 0)
+                inserted[t] += table.insertShared(MerTable::empty_key, 9);
+        });
+    }
+    threads.join_all();
+    BOOST_CHECK_EQUAL(table.capacity(), capacity);
+    BOOST_CHECK_EQUAL(table.size(), size + 1);
+    BOOST_CHECK_EQUAL(inserted[0] + inserted[1] + inserted[2] + inserted[3], size);
+    MerTable::value_type value(0);
+    for (std::size_t i(0); i < size; i++) {
+        BOOST_REQUIRE(table.find(i, value));
+        BOOST_CHECK_EQUAL(value, i == 7 ? 1 : i % 1000 + 2);
+    }
+    BOOST_CHECK(table.find(MerTable::empty_key, value));
+    BOOST_CHECK_EQUAL(value, 9);
+}
+
+BOOST_AUTO_TEST_CASE(narrow) {
+    MerTable narrow(ScoreCodec(8));
+    MerTable wide(ScoreCodec(16, ScoreCodec::Log));
+    for (mer_type key(0); key < 1000; key++) {
+        narrow.insert(key, key * 3);
+        wide.insert(key, key * 3000);
+    }
+    narrow.insert(~mer_type(0), 1000);
+    BOOST_CHECK_EQUAL(narrow.codec().bits(), 8);
+    for (mer_type key(0); key < 1000; key++) {
+        MerTable::value_type value(0);
+        BOOST_REQUIRE(narrow.find(key, value));
+        BOOST_CHECK_EQUAL(value, std::min<MerTable::value_type>(key * 3, 255));
+        BOOST_REQUIRE(wide.find(key, value));
+        BOOST_CHECK(std::fabs(double(value) - key * 3000.) <=
+                wide.codec().relativeError() * key * 3000.);
+    }
+    MerTable::value_type value(0);
+    BOOST_REQUIRE(narrow.find(~mer_type(0), value));
+    BOOST_CHECK_EQUAL(value, 255);
+
+    // rehashing and copying keep the codes
+    MerTable copy(narrow);
+    copy.reserve(100000);
+    BOOST_REQUIRE(copy.find(50, value));
+    BOOST_CHECK_EQUAL(value, 150);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,124 @@
+#define BOOST_TEST_MODULE MerTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <string>
+#include <type_traits>
+#include "../mer.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    const std::string sequence_string;
+    const Read read;
+
+    Fixture() :
+        sequence_string("tcaggggggttttaatttactttcgtacacagcgtaaatcttactaaatgtc"),
+        read(sequence_string) {
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(windows) {
+    const Read::size_type length(11);
+    MerIterator itr(read, length);
+    Read::size_type count(0);
+    while (itr.next()) {
+        BOOST_CHECK_EQUAL(itr.position(), count);
+        BOOST_CHECK(itr.read() == read.sub(count, length));
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, read.size() - length + 1);
+}
+
+BOOST_AUTO_TEST_CASE(long_windows) {
+    const Read::size_type length(40);
+    MerIterator itr(read, length);
+    Read::size_type count(0);
+    while (itr.next()) {
+        BOOST_CHECK(!itr.isPacked());
+        BOOST_CHECK(itr.read() == read.sub(count, length));
+        count++;
+    }
+    BOOST_CHECK_EQUAL(count, read.size() - length + 1);
+}
+
+BOOST_AUTO_TEST_CASE(indefinite) {
+    const Read invalid_read("acgtnacgtacgtannacgta");
+    const Read::size_type length(4);
+    MerIterator itr(invalid_read, length);
+    std::vector<Read::size_type> positions;
+    while (itr.next()) {
+        BOOST_CHECK(itr.read() == invalid_read.sub(itr.position(), length));
+        positions.push_back(itr.position());
+    }
+    Read::size_type expected[] = {0, 5, 6, 7, 8, 9, 10, 16, 17};
+    BOOST_CHECK_EQUAL_COLLECTIONS(positions.begin(), positions.end(),
+            expected, expected + 9);
+}
+
+BOOST_AUTO_TEST_CASE(short_read) {
+    const Read short_read("acgt");
+    MerIterator itr(short_read, 5);
+    BOOST_CHECK(!itr.next());
+}
+
+BOOST_AUTO_TEST_CASE(temporary) {
+    // iterators keep a reference to their read, so a temporary is refused
+    BOOST_CHECK((!std::is_constructible<MerIterator, Read, Read::size_type>::value));
+    BOOST_CHECK((!std::is_constructible<FixedMerIterator<4>, Read>::value));
+    BOOST_CHECK((std::is_constructible<MerIterator, const Read&, Read::size_type>::value));
+    BOOST_CHECK((std::is_constructible<FixedMerIterator<4>, const Read&>::value));
+}
+
+BOOST_AUTO_TEST_CASE(reverse_complement) {
+    for (Read::size_type length(1); length <= max_packed_length; length++) {
+        MerIterator itr(read, length);
+        BOOST_CHECK(itr.next());
+        const Read expected(itr.read().reverse().complement());
+        const mer_type comp(carl::reverse_complement(itr.forward(), length));
+        BOOST_CHECK_EQUAL(MerIterator::toRead(comp, length).tostring(),
+                expected.tostring());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(canonical) {
+    const Read::size_type length(13);
+    MerIterator itr(read, length);
+    while (itr.next()) {
+        const mer_type comp(carl::reverse_complement(itr.forward(), length));
+        BOOST_CHECK_EQUAL(itr.reverse(), comp);
+        BOOST_CHECK_EQUAL(itr.canonical(), carl::canonical(itr.forward(), length));
+        BOOST_CHECK(itr.canonical() <= itr.forward());
+    }
+}
+
+template <Read::size_type K>
+void check_fixed(const Read& read) {
+    MerIterator itr(read, K);
+    FixedMerIterator<K> fixed(read);
+    while (itr.next()) {
+        BOOST_REQUIRE(fixed.next());
+        BOOST_CHECK_EQUAL(fixed.position(), itr.position());
+        BOOST_CHECK_EQUAL(fixed.forward(), itr.forward());
+        BOOST_CHECK_EQUAL(fixed.reverse(), itr.reverse());
+        BOOST_CHECK_EQUAL(fixed.canonical(), itr.canonical());
+    }
+    BOOST_CHECK(!fixed.next());
+}
+
+BOOST_AUTO_TEST_CASE(fixed) {
+    // a fixed length walks the windows a runtime one does
+    const Read invalid_read("acgtnacgtacgtannacgtaggcattacgatcgatcgggatcgatcgatttagcnnacgtgtgcac");
+    check_fixed<1>(invalid_read);
+    check_fixed<4>(invalid_read);
+    check_fixed<13>(read);
+    check_fixed<13>(invalid_read);
+    check_fixed<31>(read);
+    check_fixed<32>(read);
+    check_fixed<32>(invalid_read);
+    check_fixed<32>(Read("acgt"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
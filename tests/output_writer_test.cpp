@@ -0,0 +1,94 @@
+#define BOOST_TEST_MODULE OutputWriterTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../output_writer.hpp"
+
+using namespace carl;
+
+struct Fixture {
+    std::string filename;
+
+    Fixture() {
+        std::ostringstream oss;
+        oss << "/tmp/output_writer_test_" << getpid();
+        filename = oss.str();
+    }
+    ~Fixture() {
+        std::remove(filename.c_str());
+    }
+    int open() const {
+        return ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    std::string contents() const {
+        std::ifstream ifs(filename.c_str());
+        std::ostringstream oss;
+        oss << ifs.rdbuf();
+        return oss.str();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(order) {
+    const int fd(open());
+    BOOST_REQUIRE(fd >= 0);
+    std::string expected;
+    {
+        // a small limit makes writers wait for the thread
+        OutputWriter writer(fd, 1000);
+        for (int i(0); i < 5000; i++) {
+            std::ostringstream oss;
+            oss << ">" << i << "\n" << std::string(i % 50, 'a') << "\n";
+            std::string chunk(oss.str());
+            expected += chunk;
+            writer.write(chunk);
+            BOOST_CHECK(chunk.empty());
+        }
+        std::string large(5000, 'c');
+        expected += large;
+        writer.write(large);
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.bytes(), expected.size());
+        BOOST_CHECK(writer.calls() > 0);
+        BOOST_CHECK(writer.calls() < 5001);
+    }
+    ::close(fd);
+    BOOST_CHECK(contents() == expected);
+}
+
+BOOST_AUTO_TEST_CASE(close) {
+    const int fd(open());
+    BOOST_REQUIRE(fd >= 0);
+    {
+        OutputWriter writer(fd);
+        std::string chunk("abc"), empty;
+        writer.write(chunk);
+        writer.write(empty);
+        writer.close();
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.calls(), 1);
+    }
+    {
+        // closed by the destructor
+        OutputWriter writer(fd);
+        std::string chunk("def");
+        writer.write(chunk);
+    }
+    ::close(fd);
+    BOOST_CHECK_EQUAL(contents(), "abcdef");
+}
+
+BOOST_AUTO_TEST_CASE(error) {
+    OutputWriter writer(-1);
+    std::string chunk("abc");
+    writer.write(chunk);
+    BOOST_CHECK_THROW(writer.close(), OutputWriter::WriteError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,118 @@
+#define BOOST_TEST_MODULE PipelineTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/bind/bind.hpp>
+#include "../pipeline.hpp"
+
+using namespace carl;
+using namespace boost::placeholders;
+
+void echo(const FastaReader::Record& record, std::ostream& os) {
+    os << ">" << record.info << "\n" << record.sequence.size << "\n";
+}
+
+void fail_on(const FastaReader::Record& record, std::ostream& os,
+        const std::string& info) {
+    if (record.info.str() == info)
+        throw std::runtime_error("failed on " + info);
+    echo(record, os);
+}
+
+void echo_batch(const Pipeline::batch_type& batch, std::ostream& os,
+        std::atomic<std::size_t>* batches) {
+    (*batches)++;
+    for (Pipeline::batch_type::const_iterator itr(batch.begin()); itr != batch.end(); itr++) {
+        echo(*itr, os);
+    }
+}
+
+struct Fixture {
+    const std::string filename;
+    std::string expected;
+
+    Fixture() : filename("samples/sample.fasta") {
+        FastaReader reader(filename);
+        std::ostringstream oss;
+        Pipeline(1).run(reader, &echo, oss);
+        expected = oss.str();
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(single_thread) {
+    BOOST_CHECK(!expected.empty());
+    BOOST_CHECK_EQUAL(expected.substr(0, 12), ">Dm_0000002\n");
+}
+
+BOOST_AUTO_TEST_CASE(order) {
+    for (unsigned int num_thread(2); num_thread <= 8; num_thread *= 2) {
+        FastaReader reader(filename);
+        std::ostringstream oss;
+        Pipeline(num_thread, 7).run(reader, &echo, oss);
+        BOOST_CHECK(oss.str() == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(batches) {
+    // whole batches come out as their records would one at a time
+    for (unsigned int num_thread(1); num_thread <= 4; num_thread *= 2) {
+        FastaReader reader(filename);
+        std::ostringstream oss;
+        std::atomic<std::size_t> batches(0);
+        Pipeline(num_thread, 7).runBatches(reader,
+                boost::bind(&echo_batch, _1, _2, &batches), oss);
+        BOOST_CHECK(oss.str() == expected);
+        const std::size_t records(std::count(expected.begin(), expected.end(), '>'));
+        BOOST_CHECK_EQUAL(batches.load(), (records + 6) / 7);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reuse) {
+    Pipeline pipeline(3, 100);
+    for (int i(0); i < 2; i++) {
+        FastaReader reader(filename);
+        std::ostringstream oss;
+        pipeline.run(reader, &echo, oss);
+        BOOST_CHECK(oss.str() == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(writer) {
+    std::ostringstream oss;
+    oss << "/tmp/pipeline_test_" << getpid();
+    const std::string output(oss.str());
+    for (unsigned int num_thread(1); num_thread <= 4; num_thread *= 4) {
+        const int fd(open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        BOOST_REQUIRE(fd >= 0);
+        FastaReader reader(filename);
+        OutputWriter writer(fd);
+        Pipeline(num_thread, 50).run(reader, &echo, writer);
+        writer.close();
+        close(fd);
+        std::ifstream ifs(output.c_str());
+        std::ostringstream written;
+        written << ifs.rdbuf();
+        BOOST_CHECK(written.str() == expected);
+    }
+    std::remove(output.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(exception) {
+    FastaReader reader(filename);
+    std::ostringstream oss;
+    BOOST_CHECK_THROW(Pipeline(4, 16).run(reader,
+                boost::bind(&fail_on, _1, _2, std::string("Dm_0000500")), oss),
+            std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,7 +2,9 @@
 
 #include <boost/test/included/unit_test.hpp>
 
+#include <cstdlib>
 #include <string>
+#include <set>
 #include "../read.hpp"
 
 using namespace carl;
@@ -77,4 +79,114 @@ BOOST_AUTO_TEST_CASE(isDefinite) {
     BOOST_CHECK(!invalid_sequence.isDefinite());
 }
 
+BOOST_AUTO_TEST_CASE(less) {
+    const Read complement_reverse(complement_reverse_string);
+    BOOST_CHECK(read < complement_reverse);
+    BOOST_CHECK(!(complement_reverse < read));
+    BOOST_CHECK(!(read < read));
+    BOOST_CHECK(Read("acg") < Read("acgt"));
+}
+
+std::string random_sequence(const std::size_t size) {
+    const char alphabet[] = "acgtacgtacgtn";
+    std::string retval;
+    for (std::size_t i(0); i < size; i++) {
+        retval += alphabet[std::rand() % (sizeof(alphabet) - 1)];
+    }
+    return retval;
+}
+
+std::string reverse_complement_string(const std::string& str) {
+    std::string retval;
+    for (std::string::const_reverse_iterator itr(str.rbegin()); itr != str.rend(); itr++) {
+        switch (*itr) {
+            case 'a': retval += 't'; break;
+            case 'c': retval += 'g'; break;
+            case 'g': retval += 'c'; break;
+            case 't': retval += 'a'; break;
+            default: retval += 'n'; break;
+        }
+    }
+    return retval;
+}
+
+BOOST_AUTO_TEST_CASE(words) {
+    std::srand(52);
+    for (std::size_t size(1); size < 200; size += 7) {
+        const std::string str(random_sequence(size));
+        const Read long_read(str);
+        BOOST_CHECK_EQUAL(long_read.tostring(), str);
+        BOOST_CHECK_EQUAL(long_read.reverse().complement().tostring(),
+                reverse_complement_string(str));
+        BOOST_CHECK(long_read.reverse().reverse() == long_read);
+        BOOST_CHECK(long_read.complement().complement() == long_read);
+        for (std::size_t start(0); start < size; start += 5) {
+            const std::size_t length(std::min<std::size_t>(size - start, 1 + start % 70));
+            const Read sub(long_read.sub(start, length));
+            BOOST_CHECK_EQUAL(sub.tostring(), str.substr(start, length));
+            BOOST_CHECK(sub == Read(str.substr(start, length)));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(storage) {
+    std::srand(64);
+    const std::size_t sizes[] = {0, 1, 63, 64, 65, 128};
+    for (std::size_t i(0); i < 6; i++) {
+        for (std::size_t j(0); j < 6; j++) {
+            const std::string lhs(random_sequence(sizes[i]) + std::string(sizes[i] % 3, 'n'));
+            const std::string rhs(random_sequence(sizes[j]));
+            Read read(lhs);
+            Read copy(read);
+            BOOST_CHECK_EQUAL(copy.tostring(), lhs);
+
+            copy = Read(rhs);
+            BOOST_CHECK_EQUAL(copy.tostring(), rhs);
+            copy = read;
+            BOOST_CHECK(copy == read);
+
+            Read moved(std::move(copy));
+            BOOST_CHECK_EQUAL(moved.tostring(), lhs);
+            BOOST_CHECK_EQUAL(copy.size(), 0);
+            moved = Read(rhs);
+            BOOST_CHECK_EQUAL(moved.tostring(), rhs);
+            moved = std::move(read);
+            BOOST_CHECK_EQUAL(moved.tostring(), lhs);
+            BOOST_CHECK_EQUAL(moved.isDefinite(), lhs.find('n') == std::string::npos);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hash) {
+    std::srand(41);
+    for (std::size_t size(0); size < 100; size++) {
+        const std::string str(random_sequence(size));
+        const Read long_read(str);
+        BOOST_CHECK_EQUAL(hash_value(long_read), hash_value(Read(str)));
+        if (size > 0) {
+            BOOST_CHECK_EQUAL(hash_value(long_read.sub(0, size)), hash_value(long_read));
+        }
+    }
+
+    // 41-mers that differ only in their leading bases
+    std::set<std::size_t> hashes;
+    const std::string tail(random_sequence(36));
+    const char alphabet[] = "acgtn";
+    for (std::size_t i(0); i < 5 * 5 * 5 * 5 * 5; i++) {
+        std::string head;
+        for (std::size_t j(i); head.size() < 5; j /= 5) {
+            head += alphabet[j % 5];
+        }
+        hashes.insert(hash_value(Read(head + tail)));
+    }
+    BOOST_CHECK_EQUAL(hashes.size(), 5 * 5 * 5 * 5 * 5);
+    BOOST_CHECK(hash_value(Read("acgt")) != hash_value(Read("acgtaaaa")));
+}
+
+BOOST_AUTO_TEST_CASE(sub_out_of_range) {
+    BOOST_CHECK_THROW(read.sub(0, 0), std::out_of_range);
+    BOOST_CHECK_THROW(read.sub(1, read.size()), std::out_of_range);
+    BOOST_CHECK_THROW(read.getBaseAt(read.size()), std::out_of_range);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
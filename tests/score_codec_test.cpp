@@ -0,0 +1,63 @@
+#define BOOST_TEST_MODULE ScoreCodecTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include "../score_codec.hpp"
+
+using namespace carl;
+
+BOOST_AUTO_TEST_SUITE(suite)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    const ScoreCodec codec;
+    BOOST_CHECK_EQUAL(codec.bits(), 32);
+    BOOST_CHECK_EQUAL(codec.bytes(), 4);
+    BOOST_CHECK(codec.mode() == ScoreCodec::Linear);
+    BOOST_CHECK_THROW(ScoreCodec(12), ScoreCodec::ScoreBitsError);
+    BOOST_CHECK_THROW(ScoreCodec(32, ScoreCodec::Log), ScoreCodec::ScoreBitsError);
+}
+
+BOOST_AUTO_TEST_CASE(linear) {
+    const ScoreCodec wide, narrow(8), middle(16);
+    BOOST_CHECK_EQUAL(wide.decode(wide.encode(4294967295U)), 4294967295U);
+    BOOST_CHECK_EQUAL(narrow.decode(narrow.encode(200)), 200);
+    BOOST_CHECK_EQUAL(narrow.decode(narrow.encode(256)), 255);
+    BOOST_CHECK_EQUAL(middle.decode(middle.encode(65535)), 65535);
+    BOOST_CHECK_EQUAL(middle.decode(middle.encode(1000000)), 65535);
+    BOOST_CHECK_EQUAL(narrow.relativeError(), 0.);
+    // a saturated score decodes to 255, which is not above a level of 255
+    BOOST_CHECK(narrow.keepsLevel(254));
+    BOOST_CHECK(!narrow.keepsLevel(255));
+    BOOST_CHECK(!middle.keepsLevel(70000));
+    BOOST_CHECK(wide.keepsLevel(4294967295U));
+}
+
+BOOST_AUTO_TEST_CASE(log) {
+    const unsigned int bits[] = {8, 16};
+    for (int i(0); i < 2; i++) {
+        const ScoreCodec codec(bits[i], ScoreCodec::Log);
+        for (ScoreCodec::value_type score(0); score <= codec.threshold(); score++) {
+            BOOST_CHECK_EQUAL(codec.decode(codec.encode(score)), score);
+        }
+        ScoreCodec::value_type last(0);
+        for (double score(1); score < 4294967295.; score *= 1.01) {
+            const ScoreCodec::value_type value(score);
+            const ScoreCodec::code_type code(codec.encode(value));
+            BOOST_CHECK(code < (1U << bits[i]));
+            const ScoreCodec::value_type decoded(codec.decode(code));
+            BOOST_CHECK(std::fabs(double(decoded) - value) <=
+                    codec.relativeError() * value);
+            // monotonic, so comparisons against a level keep their order
+            BOOST_CHECK(decoded >= last);
+            last = decoded;
+        }
+        BOOST_CHECK_EQUAL(codec.decode(codec.encode(4294967295U)), 4294967295U);
+    }
+    BOOST_CHECK(ScoreCodec(8, ScoreCodec::Log).keepsLevel(63));
+    BOOST_CHECK(!ScoreCodec(8, ScoreCodec::Log).keepsLevel(64));
+    BOOST_CHECK_CLOSE(ScoreCodec(8, ScoreCodec::Log).relativeError(), 0.056, 2);
+    BOOST_CHECK_CLOSE(ScoreCodec(16, ScoreCodec::Log).relativeError(), 0.00016, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
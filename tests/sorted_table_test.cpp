@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE SortedTableTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <algorithm>
+#include <map>
+#include "../sorted_table.hpp"
+
+using namespace carl;
+
+typedef std::map<mer_type, SortedTable::value_type> value_map;
+
+class Collect {
+public:
+    value_map found;
+    void operator()(const std::pair<mer_type, int>& query,
+            const SortedTable::value_type value) {
+        BOOST_CHECK(found.insert(std::make_pair(query.first, value)).second ||
+                found[query.first] == value);
+    }
+};
+
+struct Fixture {
+    value_map expected;
+    SortedTable table;
+
+    Fixture() {
+        // random 20-mers
+        SortedTable::entry_list entries;
+        mer_type key(88172645463325252ULL);
+        for (unsigned int i(0); i < 20000; i++) {
+            key ^= key << 13;
+            key ^= key >> 7;
+            key ^= key << 17;
+            const mer_type mer(key & mer_mask(20));
+            if (expected.insert(std::make_pair(mer, i % 97 + 2)).second)
+                entries.push_back(std::make_pair(mer, i % 97 + 2));
+        }
+        table = SortedTable(entries, 20);
+    }
+};
+
+BOOST_FIXTURE_TEST_SUITE(suite, Fixture)
+
+BOOST_AUTO_TEST_CASE(constructor) {
+    const SortedTable empty;
+    SortedTable::value_type value;
+    BOOST_CHECK(empty.empty());
+    BOOST_CHECK(!empty.find(0, value));
+    BOOST_CHECK_EQUAL(table.size(), expected.size());
+    BOOST_CHECK_EQUAL(table.merLength(), 20);
+}
+
+BOOST_AUTO_TEST_CASE(find) {
+    for (value_map::const_iterator itr(expected.begin()); itr != expected.end(); itr++) {
+        SortedTable::value_type value(0);
+        BOOST_REQUIRE(table.find(itr->first, value));
+        BOOST_CHECK_EQUAL(value, itr->second);
+        const mer_type next(itr->first + 1);
+        if (next <= mer_mask(20) && expected.count(next) == 0)
+            BOOST_CHECK(!table.find(next, value));
+    }
+    SortedTable::value_type value;
+    BOOST_CHECK_EQUAL(table.find(0, value), expected.count(0) > 0);
+    BOOST_CHECK_EQUAL(table.find(mer_mask(20), value), expected.count(mer_mask(20)) > 0);
+}
+
+BOOST_AUTO_TEST_CASE(sweep) {
+    // every stored mer, its neighbours and some repeats, in order
+    std::vector<std::pair<mer_type, int> > queries;
+    for (value_map::const_iterator itr(expected.begin()); itr != expected.end(); itr++) {
+        queries.push_back(std::make_pair(itr->first, 0));
+        if (itr->first < mer_mask(20))
+            queries.push_back(std::make_pair(itr->first + 1, 0));
+        if (itr->first > 0)
+            queries.push_back(std::make_pair(itr->first - 1, 0));
+        if (itr->second % 10 == 0)
+            queries.push_back(std::make_pair(itr->first, 1));
+    }
+    std::sort(queries.begin(), queries.end());
+    Collect collect;
+    table.sweep(queries.begin(), queries.end(), collect);
+    BOOST_CHECK(collect.found == expected);
+
+    Collect none;
+    const SortedTable empty;
+    empty.sweep(queries.begin(), queries.end(), none);
+    BOOST_CHECK(none.found.empty());
+}
+
+BOOST_AUTO_TEST_CASE(small) {
+    // fewer mers than buckets, and mers as long as they get
+    SortedTable::entry_list entries;
+    entries.push_back(std::make_pair(~mer_type(0), 5));
+    entries.push_back(std::make_pair(mer_type(0), 6));
+    const SortedTable longest(entries, 32);
+    SortedTable::value_type value(0);
+    BOOST_REQUIRE(longest.find(~mer_type(0), value));
+    BOOST_CHECK_EQUAL(value, 5);
+    BOOST_REQUIRE(longest.find(0, value));
+    BOOST_CHECK_EQUAL(value, 6);
+    BOOST_CHECK(!longest.find(12345, value));
+    entries.assign(1, std::make_pair(mer_type(2), 7));
+    const SortedTable single(entries, 1);
+    BOOST_CHECK(single.find(2, value));
+    BOOST_CHECK(!single.find(3, value));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+#define BOOST_TEST_MODULE StatsTest
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <sstream>
+#include "../stats.hpp"
+
+using namespace carl;
+
+BOOST_AUTO_TEST_SUITE(suite)
+
+BOOST_AUTO_TEST_CASE(timer) {
+    Stats stats;
+    {
+        Stats::Timer timer(&stats, "spin");
+        const double start(Stats::wallSeconds());
+        volatile double sink(0.);
+        while (Stats::wallSeconds() - start < 0.02) {
+            sink = sink + 1.;
+        }
+    }
+    {
+        // without a Stats a timer records nothing
+        Stats::Timer timer(NULL, "none");
+    }
+    std::ostringstream oss;
+    stats.writeJson(oss);
+    BOOST_CHECK(oss.str().find("\"spin\"") != std::string::npos);
+    BOOST_CHECK(oss.str().find("\"none\"") == std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(phases) {
+    Stats stats;
+    stats.addPhase("load", 1., 2.);
+    stats.addPhase("score", .5, 4.);
+    stats.addPhase("load", 1.5, 1.);
+    std::ostringstream oss;
+    stats.writeJson(oss);
+    BOOST_CHECK(oss.str().find(
+                "{\"name\": \"load\", \"wall_seconds\": 2.5, \"cpu_seconds\": 3}")
+            != std::string::npos);
+    BOOST_CHECK(oss.str().find("\"load\"") < oss.str().find("\"score\""));
+}
+
+BOOST_AUTO_TEST_CASE(counters) {
+    Stats stats;
+    stats.setCounter("records", 10);
+    stats.setCounter("load_factor", .25);
+    stats.setCounter("records", 12);
+    std::ostringstream json, text;
+    stats.writeJson(json);
+    BOOST_CHECK(json.str().find("\"records\": 12,") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"load_factor\": 0.25,") != std::string::npos);
+    BOOST_CHECK(json.str().find("\"peak_rss_bytes\": ") != std::string::npos);
+    stats.report(text);
+    BOOST_CHECK(text.str().find("records") != std::string::npos);
+    BOOST_CHECK(text.str().find("peak_rss_bytes") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(clocks) {
+    BOOST_CHECK(Stats::peakResidentSize() > 0);
+    BOOST_CHECK(Stats::cpuSeconds() >= 0.);
+    const double start(Stats::wallSeconds());
+    BOOST_CHECK(Stats::wallSeconds() >= start);
+}
+
+BOOST_AUTO_TEST_SUITE_END()